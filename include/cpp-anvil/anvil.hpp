@@ -2,7 +2,10 @@
 #define CPP_ANVIL_ANVIL_HPP
 
 #include "cpp-anvil/anvil/chunk.hpp"
+#include "cpp-anvil/anvil/chunk_loader.hpp"
 #include "cpp-anvil/anvil/coordinates.hpp"
 #include "cpp-anvil/anvil/region.hpp"
+#include "cpp-anvil/anvil/world.hpp"
+#include "cpp-anvil/anvil/world_index.hpp"
 
 #endif // CPP_ANVIL_ANVIL_HPP
@@ -0,0 +1,126 @@
+#ifndef CPP_ANVIL_ANVIL_CHUNK_LOADER_HPP
+#define CPP_ANVIL_ANVIL_CHUNK_LOADER_HPP
+
+#include "cpp-anvil/anvil/chunk.hpp"
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anvil {
+
+//! @brief Loads chunks of many region files asynchronously.
+//! @details
+//! Region files are queued with @ref load(). Their chunk data is read by an I/O backend that
+//! keeps many reads in flight, also across region files. Completed reads are uncompressed and
+//! parsed by a pool of decode threads, which pass every chunk to the callback.
+//!
+//! On Linux, io_uring is used if the library has been built with liburing and the kernel
+//! supports it. Otherwise a pool of threads performs positional reads.
+//!
+//! In contrast to @ref Region, the chunks are not stored by the loader. This makes it suitable
+//! for scans over whole worlds.
+class ChunkLoader
+{
+public:
+    //! @brief I/O backend used to read the chunk data.
+    enum class Backend
+    {
+        //! Blocking positional reads on a pool of threads.
+        ThreadPool,
+        //! Asynchronous reads with io_uring.
+        IoUring,
+    };
+
+    //! @brief Settings of the chunk loader.
+    struct Options
+    {
+        //! Number of threads reading chunk data with the thread pool backend. `0` uses the
+        //! hardware concurrency.
+        size_t ioThreads{4};
+        //! Number of threads uncompressing and parsing chunks. `0` uses the hardware concurrency.
+        size_t decodeThreads{0};
+        //! Maximum number of chunk reads in flight with io_uring, also the number of read chunks
+        //! waiting to be decoded.
+        size_t queueDepth{64};
+        //! Use io_uring if it is available.
+        bool useIoUring{true};
+    };
+
+    //! @brief A loaded chunk.
+    struct Result
+    {
+        //! Filename of the region file.
+        std::string filename;
+        //! Index of the chunk within the region. If the region file itself can not be read, the
+        //! index is @ref Region::Chunks.
+        size_t index{0};
+        //! The loaded chunk, empty if an error occurred.
+        Chunk chunk;
+        //! The error that occurred while loading the chunk, if any.
+        std::exception_ptr error;
+    };
+
+    //! @brief Called for every loaded chunk.
+    //! @details
+    //! The callback is invoked concurrently by the decode threads.
+    using Callback = std::function<void(Result&&)>;
+
+public:
+    //! @brief Starts the I/O and decode threads.
+    //! @param callback Called for every loaded chunk.
+    //! @param options Settings of the loader.
+    explicit ChunkLoader(Callback callback, const Options& options);
+
+    //! @brief Starts the I/O and decode threads with default settings.
+    //! @param callback Called for every loaded chunk.
+    explicit ChunkLoader(Callback callback);
+
+    ChunkLoader(const ChunkLoader&)            = delete;
+    ChunkLoader& operator=(const ChunkLoader&) = delete;
+
+    //! @brief Waits for all queued chunks and stops the threads.
+    //! @details
+    //! Exceptions thrown by the callback are discarded, call @ref wait() to receive them.
+    ~ChunkLoader();
+
+    //! @brief Queues all chunks of a region file.
+    //! @param filename Filename of the region file.
+    void load(const std::string& filename);
+
+    //! @brief Queues the chunks at the given indices of a region file.
+    //! @details
+    //! Indices of chunks that are not stored in the file are ignored, as well as chunks whose
+    //! header entries are invalid, see @ref Region::loadPartiallyFromFile().
+    //!
+    //! @param filename Filename of the region file.
+    //! @param indices Indices of the chunks to be loaded.
+    //! @throws std::out_of_range If an index is out of range.
+    void load(const std::string& filename, const std::vector<size_t>& indices);
+
+    //! @brief Waits until all queued chunks have been passed to the callback.
+    //! @throws Rethrows the first exception thrown by the callback.
+    void wait();
+
+    //! @brief Returns the I/O backend in use.
+    //! @return The I/O backend.
+    Backend backend() const;
+
+    //! @brief Checks if io_uring can be used.
+    //! @details
+    //! The library has to be built with io_uring support and the kernel has to allow creating a
+    //! ring. Loaders with @ref Options::useIoUring use the io_uring backend exactly in this case.
+    //!
+    //! @return `true` if io_uring can be used, `false` otherwise.
+    static bool isIoUringSupported();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_ANVIL_CHUNK_LOADER_HPP
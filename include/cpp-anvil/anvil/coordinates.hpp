@@ -31,6 +31,16 @@ Vec2 chunkRegion2ChunkWorld(Vec2 chunkCoord, Vec2 regionCoord);
 //! @return Chunk coordinates in region system.
 Vec2 chunkWorld2ChunkRegion(Vec2 worldWoord);
 
+//! @brief Returns the coordinates of the region containing a chunk.
+//! @param worldCoord World coordinates of chunk.
+//! @return Region coordinates in the world.
+Vec2 chunkWorld2Region(Vec2 worldCoord);
+
+//! @brief Combines region coordinates into a single key, e.g. for hash maps of regions.
+//! @param regionCoord Region coordinates in the world.
+//! @return Key that is unique for every region.
+uint64_t regionKey(Vec2 regionCoord);
+
 } // namespace anvil
 
 #endif // CPP_ANVIL_ANVIL_COORDINATES_HPP
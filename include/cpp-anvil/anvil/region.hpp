@@ -6,12 +6,16 @@
 #include "cpp-anvil/util/compression.hpp"
 
 #include <array>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
 namespace anvil {
 
+class MemoryMappedFile;
 class RegionHeader;
 
 //! @brief Class to store minecraft region data.
@@ -21,6 +25,41 @@ public:
     constexpr static size_t ChunksPerRegionAxis{32};
     constexpr static size_t Chunks{1024};
     constexpr static size_t SectorSize{4096};
+    constexpr static size_t MaxReadSectors{256};
+
+    //! @brief Defines how chunk data is read from the region file.
+    enum class FileAccess
+    {
+        //! A file stream is opened whenever chunks are read.
+        Stream,
+        //! The region file is mapped into memory once and chunks are inflated directly from the
+        //! mapped pages.
+        MemoryMapped,
+    };
+
+    //! @brief Defines the order of the chunks in a compacted region file.
+    enum class ChunkOrder
+    {
+        //! Chunks are stored in index order, row by row.
+        Index,
+        //! Chunks are stored along a Z-order curve, so that neighboring chunks are mostly stored
+        //! close to each other.
+        Morton,
+    };
+
+    //! @brief Result of a region file compaction.
+    struct CompactionResult
+    {
+        //! Size of the region file before compaction in bytes.
+        size_t originalSize{0};
+        //! Size of the compacted region file in bytes.
+        size_t compactedSize{0};
+        //! Number of bytes that have been reclaimed.
+        size_t reclaimedBytes() const
+        {
+            return (originalSize > compactedSize) ? originalSize - compactedSize : 0;
+        }
+    };
 
 public:
     //! @brief Constructs an empty region.
@@ -30,16 +69,50 @@ public:
     ~Region();
 
     //! @brief Loads the complete region file.
+    //! @details
+    //! If lazy loading is enabled, only the region header is loaded and the chunks are loaded on
+    //! first access, see @ref setLazyLoading().
+    //!
     //! @param filename Filename of the region file to be loaded.
-    void loadFromFile(const std::string& filename);
+    //! @param access How the region file is accessed.
+    void loadFromFile(const std::string& filename, FileAccess access = FileAccess::Stream);
 
     //! @brief Loads the region file only partially.
     //! @details
     //! Partial loading of the region file means that only the region header is loaded but not the
     //! chunks.
     //!
+    //! The chunk locations in the header are validated against the file size, so that chunks can
+    //! be loaded later without further checks. Chunks whose locations are invalid, e.g. behind
+    //! the end of the file or within the header, are treated as not stored, all other chunks stay
+    //! loadable. Their header entries are cleared in the file by the next save.
+    //!
+    //! With FileAccess::MemoryMapped the file is mapped here once and stays mapped until the
+    //! region is destroyed or another file is loaded. All later chunk loads read from the mapping.
+    //!
+    //! All chunks of a previously loaded file are discarded first, including unsaved changes.
+    //!
     //! @param filename Region filename to be loaded partially.
-    void loadPartiallyFromFile(const std::string& filename);
+    //! @param access How the region file is accessed.
+    //! @throws std::runtime_error If the file can not be read.
+    void loadPartiallyFromFile(const std::string& filename,
+                               FileAccess access = FileAccess::Stream);
+
+    //! @brief Enables or disables lazy loading of chunks.
+    //! @details
+    //! With lazy loading, @ref loadFromFile() only loads the region header. A chunk is read,
+    //! uncompressed and parsed when it is accessed the first time by any @ref chunkAt() overload,
+    //! so that time and memory depend on the chunks that are actually used.
+    //!
+    //! Accessing chunks of a lazily loaded region is not thread-safe, even through the const
+    //! overloads of @ref chunkAt().
+    //!
+    //! @param lazy `true` to load chunks on first access.
+    void setLazyLoading(bool lazy);
+
+    //! @brief Returns if chunks are loaded on first access.
+    //! @return `true` if lazy loading is enabled, `false` otherwise.
+    bool isLazyLoading() const;
 
     //! @brief Loads the chunk at specific index.
     //! @param index Index of the chunk to be loaded.
@@ -48,6 +121,63 @@ public:
     //! @brief Loads all chunks in the region file.
     void loadAllChunks();
 
+    //! @brief Loads all chunks in the region file using multiple threads.
+    //! @details
+    //! The compressed chunk data is read from the file first. Uncompressing and parsing of the
+    //! chunks is then distributed over @p threadCount threads. The loaded chunks are the same as
+    //! with @ref loadAllChunks(), independent of the number of threads.
+    //!
+    //! @param threadCount Number of threads. `0` uses the hardware concurrency.
+    void loadAllChunks(size_t threadCount);
+
+    //! @brief Loads the chunks at the given indices.
+    //! @details
+    //! The chunks are read in the order they are stored in the region file, not in index order.
+    //! Chunks stored in consecutive sectors are read with a single read of up to
+    //! @ref MaxReadSectors sectors, so that loading many chunks results in few sequential reads.
+    //! Uncompressing and parsing is distributed over @p threadCount threads.
+    //!
+    //! Indices of chunks that are already loaded or not stored in the file are ignored, as well as
+    //! duplicates.
+    //!
+    //! @param indices Indices of the chunks to be loaded.
+    //! @param threadCount Number of threads. `0` uses the hardware concurrency.
+    //! @throws std::out_of_range If an index is out of range.
+    void loadChunks(const std::vector<size_t>& indices, size_t threadCount = 1);
+
+    //! @brief Unloads the chunk at @p index and releases its memory.
+    //! @details
+    //! Chunks with unsaved changes are not unloaded, see @ref isChunkDirty(). With lazy loading,
+    //! the chunk is loaded again on the next access.
+    //!
+    //! @param index Index of the chunk.
+    //! @return `true` if the chunk is not loaded anymore, `false` if it has unsaved changes.
+    //! @throws std::out_of_range If index is out of range.
+    bool unloadChunk(size_t index);
+
+    //! @brief Unloads all chunks without unsaved changes.
+    //! @return Number of chunks that have been unloaded.
+    size_t unloadAll();
+
+    //! @brief Called by @ref forEachChunk() for every chunk.
+    using ChunkVisitor = std::function<void(size_t index, const Chunk& chunk)>;
+
+    //! @brief Visits all chunks stored in the region file with bounded memory.
+    //! @details
+    //! The chunks are loaded in the order they are stored in the file, in batches of up to
+    //! @ref MaxReadSectors sectors, see @ref loadChunks(). Every chunk of a batch is passed to
+    //! @p visitor and unloaded again afterwards, so only the trees of one batch are held in
+    //! memory. Chunks that have been loaded before are visited as well and stay loaded.
+    //!
+    //! @param visitor Called for every chunk, in file order.
+    //! @param threadCount Number of threads used for loading a batch. `0` uses the hardware
+    //!                    concurrency.
+    void forEachChunk(const ChunkVisitor& visitor, size_t threadCount = 1);
+
+    //! @brief Returns the number of loaded chunks.
+    //! @return Number of loaded chunks.
+    size_t loadedChunkCount() const;
+
     //! @brief Checks if a chunk is already loaded.
     //! @param index Index of chunk to check.
     //! @return `true` if chunk is loaded, `false` if not.
@@ -62,15 +192,179 @@ public:
     //! @return `true` if chunk can be loaded, `false` if not.
     bool isChunkLoadable(size_t index) const;
 
+    //! @brief Checks if a chunk has been modified since it was loaded or saved.
+    //! @details
+    //! Chunks are marked as modified by @ref markChunkDirty(), @ref setRawChunkData() and
+    //! @ref setChunkCompression(). A chunk returned by a non-const @ref chunkAt() overload may be
+    //! changed through the reference, its tree is compared with the tree at the time of the first
+    //! non-const access. Reading a chunk therefore does not make it modified.
+    //!
+    //! @param index Index of chunk to check.
+    //! @return `true` if chunk is modified, `false` if not.
+    bool isChunkDirty(size_t index) const;
+
+    //! @brief Marks the chunk at @p index as modified.
+    //! @details
+    //! Modified chunks are serialized and written by the next save and are not unloaded before.
+    //!
+    //! @param index Index of the chunk.
+    //! @throws std::out_of_range If index is out of range.
+    void markChunkDirty(size_t index);
+
+    //! @brief Ends the non-const access to a chunk.
+    //! @details
+    //! A chunk returned by a non-const @ref chunkAt() overload is compared with its previous tree
+    //! by every save, unload and check for changes, see @ref isChunkDirty(). This compares it once
+    //! and marks it as modified if its tree changed. Afterwards, changes through references to the
+    //! chunk must be marked with @ref markChunkDirty(), until the next non-const access.
+    //!
+    //! @param index Index of the chunk.
+    //! @return `true` if the chunk is modified, `false` if not.
+    //! @throws std::out_of_range If index is out of range.
+    bool commitChunk(size_t index);
+
+    //! @brief Returns the compressed data of a chunk as it is stored in the region file.
+    //! @details
+    //! The data does not contain the length and compression type prefix of the chunk sectors. It
+    //! is the data the chunk has been loaded from, or the data set by @ref setRawChunkData(). As
+    //! long as the chunk is not modified, this data is written back unchanged when saving, without
+    //! serializing and compressing the chunk again. Changes made through a non-const
+    //! @ref chunkAt() count as modifications, see @ref isChunkDirty(). This also allows copying
+    //! chunks between regions without uncompressing them:
+    //! @code
+    //! target.setRawChunkData(index, source.rawChunkData(index),
+    //!                       source.rawChunkCompression(index));
+    //! @endcode
+    //!
+    //! The returned span is valid until the chunk is modified, loaded from another file, the
+    //! region is saved, compacted or destroyed.
+    //!
+    //! @param index Index of the chunk.
+    //! @return The compressed chunk data. Empty if the chunk is modified or not stored at all.
+    //! @throws std::out_of_range If index is out of range.
+    std::span<const unsigned char> rawChunkData(size_t index) const;
+
+    //! @brief Returns the compression type of the data returned by @ref rawChunkData().
+    //! @param index Index of the chunk.
+    //! @return The compression type of the raw chunk data.
+    //! @throws std::out_of_range If index is out of range.
+    CompressionType rawChunkCompression(size_t index) const;
+
+    //! @brief Replaces a chunk by already compressed chunk data.
+    //! @details
+    //! The loaded chunk is discarded, the data is parsed when the chunk is loaded again. The chunk
+    //! is marked as modified, so that @ref saveChanges() writes the new data.
+    //!
+    //! @param index Index of the chunk.
+    //! @param data Compressed chunk data, see @ref rawChunkData().
+    //! @param compression Compression type of @p data.
+    //! @throws std::out_of_range If index is out of range.
+    //! @throws std::runtime_error If @p data is empty.
+    void setRawChunkData(size_t index, std::span<const unsigned char> data,
+                         CompressionType compression);
+
+    //! @brief Returns the compression type of a chunk.
+    //! @details
+    //! This is the compression type the chunk has been loaded with, or the one set by
+    //! @ref setChunkCompression().
+    //!
+    //! @param index Index of the chunk.
+    //! @return The compression type used when the chunk is written.
+    //! @throws std::out_of_range If index is out of range.
+    CompressionType chunkCompression(size_t index) const;
+
+    //! @brief Sets the compression type a chunk is written with.
+    //! @details
+    //! A stored chunk is loaded and marked as modified, so that it is compressed again on the next
+    //! save.
+    //!
+    //! @param index Index of the chunk.
+    //! @param compression The new compression type.
+    //! @throws std::out_of_range If index is out of range.
+    //! @throws std::runtime_error If chunks can not be compressed with @p compression, or the
+    //!                            chunk can not be loaded.
+    void setChunkCompression(size_t index, CompressionType compression);
+
+    //! @brief Compacts the region file the region has been loaded from.
+    //! @details
+    //! Sectors that are no longer referenced by the header are removed and the chunks are stored
+    //! contiguously, see @ref compactFile(). Unsaved changes are kept in the region and are not
+    //! written to the file.
+    //!
+    //! The chunks move within the file, so spans returned by @ref rawChunkData() that reference
+    //! the memory mapped file are invalid afterwards. If compaction fails, the original file is
+    //! left unchanged and no temporary file remains.
+    //!
+    //! @param order Order of the chunks in the compacted file.
+    //! @return Sizes of the file before and after compaction.
+    //! @throws std::runtime_error If the region has no filename or the file can not be compacted.
+    CompactionResult compact(ChunkOrder order = ChunkOrder::Index);
+
+    //! @brief Checks if any chunk has changes that have not been saved yet.
+    //! @details
+    //! These are the chunks that would be written by @ref saveChanges().
+    //!
+    //! @return `true` if the region has unsaved changes, `false` otherwise.
+    bool hasUnsavedChanges() const;
+
+    //! @brief Estimates the memory used by the region.
+    //! @details
+    //! The estimate includes the region object itself, the tag trees of the chunks and their raw
+    //! chunk data. Trees are measured when they are loaded and again on the next call after
+    //! @ref markChunkDirty(), so the call itself is cheap. Only the trees of chunks returned by a
+    //! non-const @ref chunkAt() overload are measured on every call, until @ref commitChunk().
+    //! Unloading chunks reduces the memory accordingly, see @ref unloadChunk().
+    //!
+    //! @return Estimated memory in bytes.
+    size_t memoryUsage() const;
+
+    //! @brief Returns the filename of the region file the region has been loaded from.
+    //! @return The filename, empty if the region has not been loaded from a file.
+    const std::string& filename() const;
+
+    //! @brief Returns how the region file is accessed.
+    //! @return The file access mode.
+    FileAccess fileAccess() const;
+
     //! @brief Saves the region to the file it has been loaded from.
     //! @return `true` if files was successfully saved, `false` otherwise.
     bool saveToFile();
 
     //! @brief Saves the region to the given filename.
+    //! @details
+    //! Chunks that have not been modified are written with their original compressed data, see
+    //! @ref rawChunkData(). Only modified chunks are serialized and compressed again, including
+    //! chunks changed through a non-const @ref chunkAt() without @ref markChunkDirty(). Chunks
+    //! that have not been loaded are copied from the source file.
+    //!
     //! @param filename The filename where the region data should be saved.
     //! @return `true` if files was successfully saved, `false` otherwise.
     bool saveToFile(const std::string& filename);
 
+    //! @brief Saves the region to the given filename using multiple threads.
+    //! @details
+    //! The chunks are serialized and compressed in parallel. Afterwards the sectors and the region
+    //! header are assigned in index order, so the file is identical to the one written by
+    //! @ref saveToFile(const std::string&).
+    //!
+    //! @param filename The filename where the region data should be saved.
+    //! @param threadCount Number of threads. `0` uses the hardware concurrency.
+    //! @return `true` if files was successfully saved, `false` otherwise.
+    bool saveToFile(const std::string& filename, size_t threadCount);
+
+    //! @brief Writes only the modified chunks to the file the region has been loaded from.
+    //! @details
+    //! A modified chunk is written in place if it still fits into its sectors, otherwise into the
+    //! first run of free sectors or appended to the end of the file. Only the header entries and
+    //! timestamps of the written chunks are updated. Modified chunks that have been cleared are
+    //! removed from the file.
+    //!
+    //! If the region file does not exist yet, the whole region is saved.
+    //!
+    //! @return `true` if the changes were successfully saved, `false` otherwise.
+    //! @throws std::runtime_error If the region has no filename or the file can not be written.
+    bool saveChanges();
+
     //! @brief Returns the x coordinate of the region.
     //! @return X coordinate.
     int32_t x() const;
@@ -84,12 +378,20 @@ public:
     Vec2 xz() const;
 
     //! @brief Gets a chunk from the region via index.
+    //! @details
+    //! With lazy loading, the chunk is loaded first. Changes made through the returned reference
+    //! are detected by the next save, see @ref isChunkDirty(). Use the const overloads to read.
+    //!
     //! @param index Index of the requested chunk. Must be in range [0, 1024).
     //! @return Reference to chunk at @p index
     //! @throws std::out_of_range If index is out of range.
     Chunk& chunkAt(size_t index);
 
     //! @brief Gets a chunk from the region by the chunk coordinate.
+    //! @details
+    //! With lazy loading, the chunk is loaded first. Changes made through the returned reference
+    //! are detected by the next save, see @ref isChunkDirty(). Use the const overloads to read.
+    //!
     //! @param x X coordinate of chunk within region. Must be in range [0, 32).
     //! @param z Y coordinate of chunk within region. Must be in range [0, 32).
     //! @return Returns chunk at coordinate x|y.
@@ -97,17 +399,27 @@ public:
     Chunk& chunkAt(int32_t x, int32_t z);
 
     //! @brief Gets a chunk from the region by the chunk coordinate.
+    //! @details
+    //! With lazy loading, the chunk is loaded first. Changes made through the returned reference
+    //! are detected by the next save, see @ref isChunkDirty(). Use the const overloads to read.
+    //!
     //! @param coord Coordinate of the chunk within the region.
     //! @return Returns chunk at passed coordinate.
     Chunk& chunkAt(const Vec2& coord);
 
     //! @brief Gets a chunk from the region via index. Must be in range [0, 1024).
+    //! @details
+    //! With lazy loading, the chunk is loaded first.
+    //!
     //! @param index Index of the requested chunk.
     //! @return Const reference to chunk at @p index
     //! @throws std::out_of_range If index is out of range.
     const Chunk& chunkAt(size_t index) const;
 
     //! @brief Gets a chunk from the region by the chunk coordinate.
+    //! @details
+    //! With lazy loading, the chunk is loaded first.
+    //!
     //! @param x X coordinate of chunk within region. Must be in range [0, 32).
     //! @param z Y coordinate of chunk within region. Must be in range [0, 32).
     //! @return Returns chunk at coordinate x|y.
@@ -115,6 +427,9 @@ public:
     const Chunk& chunkAt(int32_t x, int32_t z) const;
 
     //! @brief Gets a chunk from the region by the chunk coordinate.
+    //! @details
+    //! With lazy loading, the chunk is loaded first.
+    //!
     //! @param coord Coordinate of the chunk within the region.
     //! @return Returns chunk at passed coordinate.
     const Chunk& chunkAt(const Vec2& coord) const;
@@ -129,10 +444,119 @@ private:
     //! @param index Index of chunk to access. Must be in range [0, 1024).
     void checkRange(size_t index) const;
 
-    //! @brief Reads the chunkdata from @p filestream at chunk @p index
+    //! @brief Discards the region file and all chunks, before another file is loaded.
+    void resetChunks();
+
+    //! @brief Updates the memory usage of a chunk after its tree or raw chunk data changed.
+    //! @param index Index of the chunk.
+    //! @param treeMemory Estimated memory of the tree, 0 if the chunk is not loaded.
+    void accountChunkMemory(size_t index, size_t treeMemory) const;
+
+    //! @brief Compressed chunk data as stored in the region file.
+    struct ChunkPayload;
+
+    //! @brief Checks if the chunk tree differs from its raw chunk data.
+    //! @param index Index of the chunk.
+    //! @return `true` if the chunk must be serialized again when saving.
+    bool isChunkModified(size_t index) const;
+
+    //! @brief Checks if the tree of a chunk returned by the non-const @ref chunkAt() changed.
+    //! @param index Index of the chunk.
+    //! @return `true` if the tree differs from the one remembered by @ref rememberTree().
+    bool hasTreeChanged(size_t index) const;
+
+    //! @brief Remembers the current tree of a chunk, to detect changes by @ref hasTreeChanged().
+    //! @param index Index of the chunk.
+    void rememberTree(size_t index) const;
+
+    //! @brief Hashes the serialized tree of a chunk.
+    //! @param index Index of the chunk.
+    //! @return The hash, `0` for an empty chunk.
+    size_t treeHash(size_t index) const;
+
+    //! @brief Returns the raw chunk data at chunk @p index.
+    //! @details
+    //! The data is taken from the raw chunk cache, the memory mapped file or read from
+    //! @p filestream, in this order. The chunk must be loadable.
+    //!
+    //! @param index The chunk index to be read.
+    //! @param filestream Stream of the region file, opened on first use.
+    //! @return The compressed chunk data.
+    ChunkPayload rawChunkPayload(const size_t index, std::ifstream& filestream) const;
+
+    //! @brief Opens the region file for reading if @p filestream is not open yet.
+    //! @param filestream The filestream to be opened.
+    void openFileStream(std::ifstream& filestream) const;
+
+    //! @brief Reads the compressed data of chunks stored in consecutive sectors with one read.
     //! @param filestream The filestream to read the chunk data from.
+    //! @param indices The chunk indices to be read, ordered by their sector offset.
+    //! @param payloads The compressed data of the chunks is appended here.
+    void readChunkRun(std::ifstream& filestream, std::span<const size_t> indices,
+                      std::vector<ChunkPayload>& payloads) const;
+
+    //! @brief Reads the compressed chunk data from @p filestream at chunk @p index.
+    //! @param filestream The filestream to read the chunk data from.
+    //! @param index The chunk index to be read.
+    //! @return The compressed chunk data.
+    ChunkPayload readChunkPayload(std::ifstream& filestream, const size_t index) const;
+
+    //! @brief Returns the compressed chunk data at chunk @p index from the memory mapped file.
     //! @param index The chunk index to be read.
-    void readChunkData(std::ifstream& filestream, const size_t index);
+    //! @return The compressed chunk data, referencing the mapped file.
+    ChunkPayload readChunkPayload(const size_t index) const;
+
+    //! @brief Loads the chunk at @p index if it is loadable and not loaded yet.
+    //! @details
+    //! This is const, so that chunks of lazily loaded regions can be loaded on const access.
+    //!
+    //! @param index The chunk index to be loaded.
+    void materializeChunk(const size_t index) const;
+
+    //! @brief Uncompresses and parses the chunk payload and stores it at its chunk index.
+    //! @details
+    //! Data read from a stream is kept as raw chunk data.
+    //!
+    //! @param payload Compressed chunk data.
+    //! @param sizeHint Expected size of the uncompressed data, see @ref uncompressedSizeHint().
+    //! @return Size of the uncompressed data.
+    size_t decodeChunkData(ChunkPayload&& payload, size_t sizeHint) const;
+
+    //! @brief Estimates the uncompressed size of chunk data from the chunks decoded so far.
+    //! @param payload Compressed chunk data.
+    //! @return Estimated uncompressed size, `0` if there is no estimate yet.
+    size_t uncompressedSizeHint(const ChunkPayload& payload) const;
+
+    //! @brief Adds a decoded chunk to the compression ratio used by @ref uncompressedSizeHint().
+    //! @param compression Compression type of the chunk data.
+    //! @param compressedSize Size of the compressed data.
+    //! @param uncompressedSize Size of the uncompressed data.
+    void learnCompressionRatio(CompressionType compression, size_t compressedSize,
+                               size_t uncompressedSize) const;
+
+    //! @brief Updates the raw chunk data after @p payload has been written to the region file.
+    //! @details
+    //! Only loaded chunks keep their data in memory when the region file is read with a stream.
+    //! Otherwise the data is read from the file when it is needed again.
+    //!
+    //! @param payload Chunk data written to the region file.
+    void updateRawChunkData(ChunkPayload& payload);
+
+    //! @brief Writes length, compression type and data of a chunk to @p target.
+    //! @param target Destination, must hold at least 5 + chunkData.size() bytes.
+    //! @param compression Compression type of @p chunkData.
+    //! @param chunkData Compressed chunk data.
+    static void writeChunkSectors(unsigned char* target, CompressionType compression,
+                                  std::span<const unsigned char> chunkData);
+
+    //! @brief Returns the number of sectors needed to store @p dataSize compressed bytes.
+    //! @throws std::runtime_error If the chunk exceeds the maximum number of sectors.
+    static size_t sectorsForChunk(size_t dataSize);
+
+    //! @brief Serializes and compresses the chunk at @p index with its compression type.
+    //! @param index The chunk index to be compressed.
+    //! @return The compressed chunk data.
+    std::vector<unsigned char> compressChunkData(const size_t index) const;
 
     //! @brief Reads the region header in the region file.
     //! @param filestream The filestream to read the data from.
@@ -153,6 +577,23 @@ public:
     //! @return `true` if the filename is valid, `false` otherwiese.
     static bool validateAndParseRegionFilename(const std::string& filename, int32_t& x, int32_t& z);
 
+    //! @brief Writes a compacted copy of a region file.
+    //! @details
+    //! The chunks are copied one after another without uncompressing them, so only the data of a
+    //! single chunk is held in memory. Each chunk occupies only the sectors it needs and the
+    //! chunks are stored without gaps. Timestamps are kept. Chunks with invalid header entries are
+    //! not copied, see @ref loadPartiallyFromFile().
+    //!
+    //! @param inputFilename Region file to be compacted.
+    //! @param outputFilename File the compacted region is written to, must differ from
+    //!                       @p inputFilename.
+    //! @param order Order of the chunks in the compacted file.
+    //! @return Sizes of the file before and after compaction.
+    //! @throws std::runtime_error If the files can not be read or written.
+    static CompactionResult compactFile(const std::string& inputFilename,
+                                        const std::string& outputFilename,
+                                        ChunkOrder order = ChunkOrder::Index);
+
     //! @brief Converts chunk coordinates to chunk index.
     //! @param x X coordinate of chunk.
     //! @param z Y coordinate of chunk.
@@ -169,11 +610,40 @@ private:
     int32_t m_z{0};
     std::string m_filename;
 
-    std::array<bool, Chunks> m_loadedChunks;
-    std::array<Chunk, Chunks> m_chunks;
-    std::array<CompressionType, Chunks> m_chunkCompression;
+    // Mutable, chunks of lazily loaded regions are loaded on const access.
+    mutable std::array<bool, Chunks> m_loadedChunks;
+    mutable std::array<Chunk, Chunks> m_chunks;
+    mutable std::array<CompressionType, Chunks> m_chunkCompression;
+    mutable std::array<bool, Chunks> m_dirtyChunks;
+    bool m_lazyLoading{false};
+
+    //! Chunks returned by the non-const @ref chunkAt() and the hashes of their trees at that time,
+    //! the last load or the last save, see @ref hasTreeChanged().
+    mutable std::array<bool, Chunks> m_accessedChunks;
+    mutable std::array<size_t, Chunks> m_treeHashes;
+
+    //! Compressed data of the chunks, see @ref rawChunkData(). Not used for data that can be
+    //! referenced in the memory mapped file.
+    mutable std::array<std::vector<unsigned char>, Chunks> m_rawChunks;
+
+    //! Estimated memory of the chunk trees and capacity of the raw chunk data, as accounted in
+    //! @ref m_memoryUsage. See @ref memoryUsage().
+    mutable std::array<size_t, Chunks> m_chunkMemory;
+    mutable std::array<size_t, Chunks> m_rawMemory;
+    mutable std::atomic<size_t> m_memoryUsage{0};
+
+    //! Chunks marked as modified since the last @ref memoryUsage(), their trees are measured again.
+    mutable std::vector<size_t> m_unmeasuredChunks;
+
+    //! Chunks with invalid header entries in the file, see @ref loadPartiallyFromFile().
+    std::vector<size_t> m_invalidChunks;
+
+    //! Compressed and uncompressed size of all decoded chunks, see @ref uncompressedSizeHint().
+    mutable std::atomic<size_t> m_compressedBytes{0};
+    mutable std::atomic<size_t> m_uncompressedBytes{0};
 
     std::unique_ptr<RegionHeader> m_regionHeader;
+    std::unique_ptr<MemoryMappedFile> m_mappedFile;
 };
 
 } // namespace anvil
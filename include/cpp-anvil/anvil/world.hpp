@@ -0,0 +1,163 @@
+#ifndef CPP_ANVIL_ANVIL_WORLD_HPP
+#define CPP_ANVIL_ANVIL_WORLD_HPP
+
+#include "cpp-anvil/anvil/chunk.hpp"
+#include "cpp-anvil/anvil/coordinates.hpp"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace anvil {
+
+class Region;
+
+//! @brief Class to access the regions and chunks of a minecraft save directory.
+//! @details
+//! The region files are expected in the `region` subdirectory of the save directory, named
+//! `r.X.Z.mca`. Regions are opened on first access with lazy loading, so only the chunks that
+//! are actually used are loaded.
+//!
+//! Open regions are kept in a cache ordered by their last access. When the estimated memory of
+//! the cached regions exceeds the memory budget, the least recently used regions without unsaved
+//! changes are closed. Regions with unsaved changes are never closed, but their unmodified chunks
+//! are unloaded if the budget is still exceeded. Call @ref saveAll() to release them completely.
+//! References to regions and chunks are therefore only valid until the next access to the world.
+class World
+{
+public:
+    constexpr static size_t DefaultMemoryBudget{256u * 1024u * 1024u};
+
+public:
+    //! @brief Creates a world for the given save directory.
+    //! @param directory The save directory, containing the `region` directory.
+    //! @param memoryBudget Memory budget of the cached regions in bytes.
+    explicit World(const std::string& directory, size_t memoryBudget = DefaultMemoryBudget);
+
+    //! @brief Destroys the world. Unsaved changes are discarded.
+    ~World();
+
+    World(const World&)            = delete;
+    World& operator=(const World&) = delete;
+
+    //! @brief Returns the save directory.
+    //! @return The save directory.
+    const std::string& directory() const;
+
+    //! @brief Returns the filename of a region file.
+    //! @param regionCoord Coordinate of the region in the world.
+    //! @return The filename, the file does not need to exist.
+    std::string regionFilename(const Vec2& regionCoord) const;
+
+    //! @brief Returns the coordinates of all region files in the save directory.
+    //! @return Region coordinates, in no particular order.
+    std::vector<Vec2> regionCoordinates() const;
+
+    //! @brief Gets a region, opening it if it is not cached.
+    //! @details
+    //! If the region file does not exist, an empty region is created. It is written to a new
+    //! region file by @ref saveAll().
+    //!
+    //! @param regionCoord Coordinate of the region in the world.
+    //! @return Reference to the region, valid until the next access to the world.
+    //! @throws std::runtime_error If the region file can not be read.
+    Region& regionAt(const Vec2& regionCoord);
+
+    //! @brief Gets a region, opening it if it is not cached.
+    //! @param regionCoord Coordinate of the region in the world.
+    //! @return Const reference to the region, valid until the next access to the world.
+    //! @throws std::runtime_error If the region file can not be read.
+    const Region& regionAt(const Vec2& regionCoord) const;
+
+    //! @brief Gets a chunk by its world coordinate.
+    //! @details
+    //! The chunk is loaded if necessary, see @ref Region::chunkAt(). Changes made through the
+    //! returned reference are detected by the next access to the world, the region is then kept
+    //! open until it is saved by @ref saveAll(). Use the const overload to read.
+    //!
+    //! @param chunkCoord World coordinate of the chunk.
+    //! @return Reference to the chunk, valid until the next access to the world.
+    Chunk& chunkAt(const Vec2& chunkCoord);
+
+    //! @brief Gets a chunk by its world coordinate.
+    //! @param chunkCoord World coordinate of the chunk.
+    //! @return Const reference to the chunk, valid until the next access to the world.
+    const Chunk& chunkAt(const Vec2& chunkCoord) const;
+
+    //! @brief Marks a chunk as modified, see @ref Region::markChunkDirty().
+    //! @details
+    //! Regions with modified chunks are kept open until they are saved by @ref saveAll().
+    //!
+    //! @param chunkCoord World coordinate of the chunk.
+    void markChunkDirty(const Vec2& chunkCoord);
+
+    //! @brief Saves all cached regions with unsaved changes.
+    //! @details
+    //! Existing region files are updated with @ref Region::saveChanges(). New regions are written
+    //! to new region files and closed afterwards.
+    //!
+    //! @return `true` if all regions were saved successfully, `false` otherwise.
+    bool saveAll();
+
+    //! @brief Returns the memory budget of the cached regions.
+    //! @return Memory budget in bytes.
+    size_t memoryBudget() const;
+
+    //! @brief Sets the memory budget of the cached regions and closes regions if necessary.
+    //! @param memoryBudget Memory budget in bytes.
+    void setMemoryBudget(size_t memoryBudget);
+
+    //! @brief Returns the estimated memory of all cached regions.
+    //! @return Estimated memory in bytes, see @ref Region::memoryUsage().
+    size_t memoryUsage() const;
+
+    //! @brief Returns the number of cached regions.
+    //! @return Number of cached regions.
+    size_t cachedRegionCount() const;
+
+    //! @brief Checks if a region is cached.
+    //! @param regionCoord Coordinate of the region in the world.
+    //! @return `true` if the region is cached, `false` otherwise.
+    bool isRegionCached(const Vec2& regionCoord) const;
+
+private:
+    struct CachedRegion
+    {
+        Vec2 coord;
+        std::unique_ptr<Region> region;
+    };
+    using RegionList = std::list<CachedRegion>;
+
+    //! @brief Returns the cached region, opens it if necessary and marks it as used last.
+    Region& cachedRegion(const Vec2& regionCoord) const;
+
+    //! @brief Closes the least recently used regions until the memory budget is met.
+    //! @details
+    //! If this is not enough, the unmodified chunks of the remaining regions are unloaded.
+    //!
+    //! @param keep Region that must not be closed or unloaded.
+    void enforceMemoryBudget(const Region* keep) const;
+
+    //! @brief Marks the chunk of the last non-const @ref chunkAt() as modified if it changed.
+    //! @details
+    //! The returned reference is only valid until the next access, so the chunk is compared once
+    //! instead of on every check for unsaved changes, see @ref Region::commitChunk().
+    void commitAccessedChunk() const;
+
+private:
+    std::string m_directory;
+    size_t m_memoryBudget;
+
+    // The cache is mutable, regions and chunks are loaded on const access as well.
+    mutable RegionList m_regions; // Most recently used first
+    mutable std::unordered_map<uint64_t, RegionList::iterator> m_regionIndex;
+    mutable std::optional<Vec2> m_accessedChunk; // Chunk of the last non-const chunkAt()
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_ANVIL_WORLD_HPP
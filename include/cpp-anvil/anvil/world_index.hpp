@@ -0,0 +1,87 @@
+#ifndef CPP_ANVIL_ANVIL_WORLD_INDEX_HPP
+#define CPP_ANVIL_ANVIL_WORLD_INDEX_HPP
+
+#include "cpp-anvil/anvil/coordinates.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace anvil {
+
+//! @brief Index of the chunks stored in the region files of a world.
+//! @details
+//! The index is built from the region headers only, no chunk data is read. For every region it
+//! stores which chunks exist, the number of sectors they occupy and the time they were last
+//! written. This takes about 5 KiB per region.
+class WorldIndex
+{
+public:
+    constexpr static size_t ChunksPerRegion{1024};
+
+public:
+    //! @brief Creates an empty index.
+    WorldIndex() = default;
+
+    //! @brief Scans the region headers of a save directory.
+    //! @details
+    //! The region files in the `region` subdirectory are read in parallel, only the 8 KiB header
+    //! of every file is read. Files that are too small to contain a header are skipped. Chunks
+    //! pointing behind the end of their file are not added to the index.
+    //!
+    //! @param directory The save directory, containing the `region` directory.
+    //! @param threadCount Number of threads. `0` uses the hardware concurrency.
+    //! @return The index of the world.
+    static WorldIndex scan(const std::string& directory, size_t threadCount = 0);
+
+    //! @brief Returns the number of indexed regions.
+    size_t regionCount() const;
+
+    //! @brief Returns the number of indexed chunks.
+    size_t chunkCount() const;
+
+    //! @brief Returns the number of region files that could not be read.
+    size_t skippedRegionCount() const;
+
+    //! @brief Returns the coordinates of all indexed regions.
+    //! @return Region coordinates, in no particular order.
+    std::vector<Vec2> regionCoordinates() const;
+
+    //! @brief Checks if a chunk is stored in the world.
+    //! @param chunkCoord World coordinate of the chunk.
+    //! @return `true` if the chunk exists, `false` otherwise.
+    bool contains(const Vec2& chunkCoord) const;
+
+    //! @brief Returns the number of sectors used by a chunk.
+    //! @param chunkCoord World coordinate of the chunk.
+    //! @return Number of 4 KiB sectors, `0` if the chunk does not exist.
+    size_t sectorCount(const Vec2& chunkCoord) const;
+
+    //! @brief Returns the time a chunk was last written.
+    //! @param chunkCoord World coordinate of the chunk.
+    //! @return Seconds since epoch, `0` if the chunk does not exist.
+    uint32_t timestamp(const Vec2& chunkCoord) const;
+
+private:
+    struct RegionEntry
+    {
+        std::bitset<ChunksPerRegion> present;
+        std::array<uint8_t, ChunksPerRegion> sectors{};
+        std::array<uint32_t, ChunksPerRegion> timestamps{};
+    };
+
+    //! @brief Finds the region entry and the chunk index of a chunk.
+    //! @return The region entry, `nullptr` if the region is not indexed.
+    const RegionEntry* findChunk(const Vec2& chunkCoord, size_t& index) const;
+
+private:
+    std::unordered_map<uint64_t, RegionEntry> m_regions;
+    size_t m_skippedRegions{0};
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_ANVIL_WORLD_INDEX_HPP
@@ -6,7 +6,10 @@
 #include "cpp-anvil/nbt/compound_tag.hpp"
 #include "cpp-anvil/nbt/io.hpp"
 #include "cpp-anvil/nbt/list_tag.hpp"
+#include "cpp-anvil/nbt/parser.hpp"
 #include "cpp-anvil/nbt/primitive_tag.hpp"
+#include "cpp-anvil/nbt/tag_arena.hpp"
 #include "cpp-anvil/nbt/types.hpp"
+#include "cpp-anvil/nbt/view.hpp"
 
 #endif // CPP_NBT_NBT_HPP
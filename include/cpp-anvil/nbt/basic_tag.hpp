@@ -1,11 +1,13 @@
 #ifndef CPP_ANVIL_NBT_BASIC_TAG_HPP
 #define CPP_ANVIL_NBT_BASIC_TAG_HPP
 
+#include "cpp-anvil/nbt/detail/name_table.hpp"
 #include "cpp-anvil/nbt/types.hpp"
 
 #include <memory>
+#include <string_view>
 #include <type_traits>
-#include <typeinfo>
+#include <utility>
 
 namespace anvil {
 
@@ -36,34 +38,50 @@ public:
 
     //! @brief Copy constructs basic tag.
     //! @param other Other tag.
-    BasicTag(const BasicTag& other) = default;
+    BasicTag(const BasicTag& other) noexcept
+        : m_name(other.m_name)
+    {
+        detail::acquireName(m_name);
+    }
 
     //! @brief Move constructs basic tag.
     //! @param other Other tag.
-    BasicTag(BasicTag&& other) noexcept = default;
+    BasicTag(BasicTag&& other) noexcept
+        : m_name(std::exchange(other.m_name, detail::emptyName())) { };
 
     //! @brief Constructs basic tag with name.
     //! @param name Name to be set.
     explicit BasicTag(const StringType& name)
-        : m_name(name) { };
+        : m_name(detail::internName(name)) { };
 
     //! @brief Constructs basic tag with name. Moves given aprameter.
     //! @param name NName to be set.
     explicit BasicTag(StringType&& name) noexcept
-        : m_name(std::move(name)) { };
+        : m_name(detail::internName(std::move(name))) { };
 
     //! @brief Destroys basic tag.
-    virtual ~BasicTag() = default;
+    virtual ~BasicTag() { detail::releaseName(m_name); }
 
     //! @brief Assigns @p other basic tag to this tag.
     //! @param other Other tag to be assigned.
     //! @return Returns reference to this tag.
-    BasicTag& operator=(const BasicTag& other) = default;
+    BasicTag& operator=(const BasicTag& other) noexcept
+    {
+        detail::acquireName(other.m_name);
+        replaceName(other.m_name);
+        return *this;
+    }
 
     //! @brief Move assigns @p other basic tag to this tag.
     //! @param other Other tag to be moved.
     //! @return Returns reference to this tag.
-    BasicTag& operator=(BasicTag&& other) noexcept = default;
+    BasicTag& operator=(BasicTag&& other) noexcept
+    {
+        if(this != &other) {
+            replaceName(std::exchange(other.m_name, detail::emptyName()));
+        }
+        return *this;
+    }
 
     //! @brief Returns type of this tag.
     //! @details
@@ -78,15 +96,32 @@ public:
 
     //! @brief Returns name of this tag.
     //! @return Tag name.
-    StringType name() { return m_name; }
+    StringType name() { return *m_name; }
 
     //! @brief Returns constant reference to name of this tag.
+    //! @details
+    //! Names are interned, tags with equal names return references to the same string.
+    //!
     //! @return Tag name.
-    const StringType& name() const { return m_name; }
+    const StringType& name() const { return *m_name; }
 
     //! @brief Assigns a new name to the tag.
+    //! @details
+    //! If the tag is a child of a compound, the compound updates its index of the child names.
+    //!
     //! @param name New string to be assigned.
-    void setName(const StringType& name) { m_name = name; }
+    void setName(std::string_view name) { replaceName(detail::internName(name)); }
+
+    //! @brief Assigns a name that is already interned.
+    //! @details
+    //! The tag acquires its own reference to the name.
+    //!
+    //! @param name Interned name, returned by detail::internName() or detail::NameCache.
+    void setInternedName(const StringType* name) noexcept
+    {
+        detail::acquireName(name);
+        replaceName(name);
+    }
 
     //! @brief Checks if this tag is an End tag.
     //! @return `true` if checked tag is an End tag, `false` otherwise.
@@ -295,7 +330,7 @@ protected:
     //! @return Returns `true` if @p lhs is equal to @p rhs.
     friend bool operator==(const BasicTag& lhs, const BasicTag& rhs)
     {
-        return &lhs == &rhs || (typeid(lhs) == typeid(rhs) && lhs.isEqual(rhs));
+        return &lhs == &rhs || (lhs.type() == rhs.type() && lhs.isEqual(rhs));
     }
 
     //! @brief Compares two tags with each other for inequality.
@@ -305,7 +340,28 @@ protected:
     friend bool operator!=(const BasicTag& lhs, const BasicTag& rhs) { return !(lhs == rhs); }
 
 private:
-    StringType m_name;
+    friend class TagArena;
+    friend class CompoundTag;
+
+    //! @brief Checks if the tag was created by @ref TagArena::make().
+    virtual bool isArenaAllocated() const noexcept { return false; }
+
+    //! @brief Replaces the name by @p name, whose reference is taken over by the tag.
+    void replaceName(const StringType* name) noexcept
+    {
+        const StringType* previous = std::exchange(m_name, name);
+        if(m_parent != nullptr && previous != name) {
+            notifyRenamed(previous);
+        }
+        detail::releaseName(previous);
+    }
+
+    //! @brief Tells the parent compound that the tag was renamed from @p previous.
+    void notifyRenamed(const StringType* previous) noexcept;
+
+private:
+    const StringType* m_name{detail::emptyName()}; // Owns a reference, see detail::internName()
+    CompoundTag* m_parent{nullptr};                // Compound containing the tag, not copied
 };
 
 //! @brief Casts a basic tag pointer into a derived basic tag type.
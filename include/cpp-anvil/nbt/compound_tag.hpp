@@ -4,45 +4,151 @@
 #include "cpp-anvil/nbt/collection_tag.hpp"
 #include "cpp-anvil/nbt/types.hpp"
 
+#include <string_view>
+#include <utility>
+#include <vector>
+
 namespace anvil {
 
+//! @brief Tag containing named child tags.
+//! @details
+//! Compounds with at least @ref IndexThreshold children keep an index of the child names, sorted
+//! by their interned name, so children are found by a binary search. The index is kept up to date
+//! by every function of the compound that adds, removes, replaces or reorders children and by
+//! renaming a child, lookups never change it. The children keep their insertion order.
+//!
+//! The children are only mutable through the compound: value(), the iterators and the element
+//! access return constant references to the owning pointers. The children themselves stay
+//! mutable, use @ref replaceAt() to replace one.
 class CompoundTag : public CollectionTag<std::unique_ptr<BasicTag>, TagType::Compound>
 {
 public:
-    CompoundTag()                             = default;
-    CompoundTag(const CompoundTag& other)     = default;
-    CompoundTag(CompoundTag&& other) noexcept = default;
+    //! @brief Minimum number of children for an index of the child names.
+    constexpr static size_type IndexThreshold{8};
+
+public:
+    CompoundTag() = default;
+    CompoundTag(const CompoundTag& other)
+        : CollectionTag(other)
+    {
+        attachChildren();
+    }
+    CompoundTag(CompoundTag&& other) noexcept
+        : CollectionTag(std::move(other))
+        , m_index(std::move(other.m_index))
+    {
+        other.m_index.clear();
+        for(auto& child : m_value) {
+            child->m_parent = this;
+        }
+    }
     explicit CompoundTag(const std::string& name)
         : CollectionTag(name)
     { }
     explicit CompoundTag(const ContainerType<value_type>& value)
         : CollectionTag(value)
-    { }
+    {
+        attachChildren();
+    }
     explicit CompoundTag(const std::string& name, const ContainerType<value_type>& value) noexcept
         : CollectionTag(name, value)
-    { }
+    {
+        attachChildren();
+    }
     virtual ~CompoundTag() = default;
 
-    CompoundTag& operator=(const CompoundTag& other)     = default;
-    CompoundTag& operator=(CompoundTag&& other) noexcept = default;
+    CompoundTag& operator=(const CompoundTag& other);
+    CompoundTag& operator=(CompoundTag&& other) noexcept;
 
     virtual std::unique_ptr<BasicTag> clone() const override
     {
         return std::make_unique<CompoundTag>(*this);
     }
 
-    bool hasChild(const std::string& name) const;
-    BasicTag* getChildByName(const std::string& name);
-    const BasicTag* getChildByName(const std::string& name) const;
+    //! @brief Returns the children.
+    //! @return Constant container of the children, use the functions of the compound to change it.
+    const ContainerType<value_type>& value() const { return m_value; }
+    void setValue(const ContainerType<value_type>& value);
+    void copy(const ContainerType<value_type>& otherValue);
+
+    // Iterators and element access of the children, the owning pointers are constant
+    constexpr const_iterator begin() const noexcept { return m_value.begin(); }
+    constexpr const_iterator end() const noexcept { return m_value.end(); }
+    constexpr const_reverse_iterator rbegin() const noexcept { return m_value.rbegin(); }
+    constexpr const_reverse_iterator rend() const noexcept { return m_value.rend(); }
+
+    constexpr const_reference at(size_type pos) const { return m_value.at(pos); }
+    constexpr const_reference operator[](size_type pos) const { return m_value[pos]; }
+    constexpr const_reference front() const { return m_value.front(); }
+    constexpr const_reference back() const { return m_value.back(); }
+
+    bool hasChild(std::string_view name) const;
+    BasicTag* getChildByName(std::string_view name);
+    const BasicTag* getChildByName(std::string_view name) const;
 
     bool push_back(std::unique_ptr<BasicTag> value);
     bool push_back(BasicTag* value);
     bool push_back(const BasicTag& value);
 
+    //! @brief Replaces the child at @p index by @p value.
+    //! @param index Index of the child to be replaced.
+    //! @param value The new child.
+    //! @return The replaced child, `nullptr` if @p index is out of range or @p value is empty.
+    std::unique_ptr<BasicTag> replaceAt(size_type index, std::unique_ptr<BasicTag> value);
+
     std::unique_ptr<BasicTag> takeAt(size_type index);
     std::unique_ptr<BasicTag> take(BasicTag* tag);
 
     bool erase(BasicTag* tag);
+    bool eraseAt(size_type index);
+    void clear();
+    void swap(size_t indexA, size_t indexB);
+
+    //! @brief Builds the index of the child names, regardless of the number of children.
+    void buildIndex();
+
+    //! @brief Checks if the compound has an index of the child names.
+    //! @return `true` if the children are indexed, `false` otherwise.
+    bool isIndexed() const { return !m_index.empty(); }
+
+private:
+    friend class BasicTag;
+
+    //! @brief An interned name and the first child with that name.
+    struct IndexEntry
+    {
+        const StringType* name;
+        BasicTag* child;
+        size_type count; // Number of children with the name
+    };
+
+    //! @brief Finds the first child with the interned @p name.
+    const BasicTag* findChild(const StringType* name) const;
+
+    //! @brief Finds the first child with the interned @p name by a linear search.
+    BasicTag* findFirstChild(const StringType* name) const;
+
+    //! @brief Sets the parent of all children and updates the index.
+    void attachChildren();
+
+    //! @brief Builds the index if the compound has enough children, clears it otherwise.
+    void updateIndex();
+
+    //! @brief Adds @p child, which is already contained in the compound, to the index.
+    void indexChild(BasicTag* child);
+
+    //! @brief Removes @p child named @p name from the index, after it has left the compound.
+    void unindexChild(BasicTag* child, const StringType* name);
+
+    //! @brief Moves @p child in the index from the name @p previous to its current name.
+    void renameChild(BasicTag* child, const StringType* previous) noexcept;
+
+    //! @brief Removes the child at @p index from the compound.
+    std::unique_ptr<BasicTag> removeAt(size_type index);
+
+private:
+    // Names of the children, sorted by the address of the interned name
+    std::vector<IndexEntry> m_index;
 };
 
 } // namespace anvil
@@ -0,0 +1,153 @@
+#ifndef CPP_ANVIL_NBT_DETAIL_NAME_TABLE_HPP
+#define CPP_ANVIL_NBT_DETAIL_NAME_TABLE_HPP
+
+#include "cpp-anvil/nbt/types.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+namespace anvil {
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Interned tag names
+//
+// Tag names are stored once in a global table, tags only point to their name. Equal names
+// therefore have the same address, which makes comparing names a pointer comparison. Names are
+// reference counted: every tag owns a reference to its name, and a name is removed from the table
+// when the last reference is released. Looking up a name that is in the table only takes a shared
+// lock.
+
+//! @brief Entry of the name table, a name with its reference count.
+struct InternedName : StringType
+{
+    InternedName() = default;
+    explicit InternedName(std::string_view name)
+        : StringType(name)
+    { }
+    explicit InternedName(StringType&& name) noexcept
+        : StringType(std::move(name))
+    { }
+
+    mutable std::atomic<size_t> references{0};
+};
+
+//! @brief Returns the empty name, which is used by default and for the elements of lists.
+//! @details
+//! The empty name is not reference counted, it is valid until the end of the program.
+//!
+//! @return The empty name.
+const StringType* emptyName() noexcept;
+
+//! @brief Returns the interned name, adding it to the table if necessary.
+//! @param name The name.
+//! @return The interned name, the caller owns a reference, see @ref releaseName().
+const StringType* internName(std::string_view name);
+
+//! @brief Returns the interned name, adding it to the table if necessary.
+//! @param name The name, moved into the table if it is not interned yet.
+//! @return The interned name, the caller owns a reference, see @ref releaseName().
+const StringType* internName(StringType&& name);
+
+//! @brief Returns the interned name, adding it to the table if necessary.
+//! @param name The name.
+//! @return The interned name, the caller owns a reference, see @ref releaseName().
+inline const StringType* internName(const char* name)
+{
+    return internName(std::string_view(name));
+}
+
+//! @brief Returns the interned name if it is in the table.
+//! @details
+//! No reference is acquired. The name is only valid as long as some other reference to it exists,
+//! it is meant for comparing addresses with the names of existing tags.
+//!
+//! @param name The name.
+//! @return The interned name, `nullptr` if no tag has the name.
+const StringType* findName(std::string_view name);
+
+//! @brief Removes a name without references from the table, see @ref releaseName().
+void eraseName(const InternedName* name) noexcept;
+
+//! @brief Acquires another reference to an interned name.
+//! @param name The interned name, the caller must already own a reference to it.
+inline void acquireName(const StringType* name) noexcept
+{
+    // The empty name is the only empty interned name.
+    if(!name->empty()) {
+        static_cast<const InternedName*>(name)->references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//! @brief Releases a reference to an interned name, the name is freed with its last reference.
+//! @param name The interned name.
+inline void releaseName(const StringType* name) noexcept
+{
+    if(!name->empty()) {
+        const auto* interned = static_cast<const InternedName*>(name);
+        if(interned->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            eraseName(interned);
+        }
+    }
+}
+
+//! @brief Direct mapped cache of interned names.
+//! @details
+//! Interning a name that is in the cache is a single string comparison. This is used when many
+//! names are interned in a row, e.g. when reading NBT data. The cache owns a reference to each
+//! cached name, which is released when the name is replaced or the cache is destroyed.
+class NameCache
+{
+public:
+    NameCache() = default;
+    ~NameCache()
+    {
+        for(const StringType* name : m_names) {
+            if(name != nullptr) {
+                releaseName(name);
+            }
+        }
+    }
+
+    NameCache(const NameCache&)            = delete;
+    NameCache& operator=(const NameCache&) = delete;
+
+    //! @brief Returns the interned name, see @ref internName().
+    //! @param name The name.
+    //! @return The interned name, valid as long as the cache. No reference is acquired.
+    const StringType* intern(std::string_view name)
+    {
+        if(name.empty()) {
+            return emptyName();
+        }
+
+        // A cheap hash is enough, a tree only uses few distinct names.
+        const size_t hash = name.size() * 31u + static_cast<unsigned char>(name.front()) * 7u
+                            + static_cast<unsigned char>(name[name.size() / 2]) * 3u
+                            + static_cast<unsigned char>(name.back());
+        const StringType*& cached = m_names[hash % m_names.size()];
+        if(cached == nullptr || std::string_view(*cached) != name) {
+            const StringType* interned = internName(name);
+            if(cached != nullptr) {
+                releaseName(cached);
+            }
+            cached = interned;
+        }
+        return cached;
+    }
+
+private:
+    std::array<const StringType*, 256> m_names{};
+};
+
+//! @brief Returns the number of interned names.
+//! @return Number of names in the table.
+size_t internedNameCount();
+
+} // namespace detail
+} // namespace anvil
+
+#endif // CPP_ANVIL_NBT_DETAIL_NAME_TABLE_HPP
@@ -59,6 +59,19 @@ bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
 bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
                 CompressionType compressionType, int compressionLevel);
 
+//! @brief Writes a byte sequence of data to file.
+//! @details
+//! Gzip and zlib compression is done on @p threadCount threads, see @ref deflate_gzip().
+//!
+//! @param filename Filename to writte data to.
+//! @param data Data to be saved.
+//! @param compressionType  The compression type if the data should be compressed.
+//! @param compressionLevel The level of compression.
+//! @param threadCount Number of compression threads. `0` uses the hardware concurrency.
+//! @return `true` on success, `false` otherwise.
+bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
+                CompressionType compressionType, int compressionLevel, size_t threadCount);
+
 //! @brief Serializes the CompoundTag and saves the data to file.
 //! @param filename Filename where the serialized tag is written to.
 //! @param compoundTag The CompoundTag to be serialized.
@@ -82,14 +95,46 @@ bool saveToFile(const std::string& filename, const CompoundTag* compoundTag,
 bool saveToFile(const std::string& filename, const CompoundTag* compoundTag,
                 CompressionType compressionType, int compressionLevel);
 
+//! @brief Serializes the CompoundTag and saves the data to file.
+//! @details
+//! Gzip and zlib compression is done on @p threadCount threads, see @ref deflate_gzip().
+//!
+//! @param filename Filename where the serialized tag is written to.
+//! @param compoundTag The CompoundTag to be serialized.
+//! @param compressionType The compression type if the data should be compressed.
+//! @param compressionLevel The level of compression.
+//! @param threadCount Number of compression threads. `0` uses the hardware concurrency.
+//! @return `true` on success, `false` otherwise.
+bool saveToFile(const std::string& filename, const CompoundTag* compoundTag,
+                CompressionType compressionType, int compressionLevel, size_t threadCount);
+
+//! @brief Settings of @ref readData().
+struct ReadOptions
+{
+    //! Store lists of numbers packed, without a tag per element, see @ref ListTag. Their values
+    //! are accessed with ListTag::values(), the tag interface throws until they are unpacked.
+    bool packLists{false};
+};
+
 //! @brief Deserializes a sequence of bytes into a NBT CompoundTag.
 //! @details
-//! The first tag in the sequence must be a CompoundTag.
+//! The first tag in the sequence must be a CompoundTag. The tags are built from the events of
+//! @ref parseData(), use it directly to extract data without building all tags. The elements of
+//! all lists are tags.
 //!
 //! @param data Sequence of bytes to be deserialized.
 //! @return CompoudTag with all contents.
+//! @throws std::runtime_error If the data is not valid NBT data.
 std::unique_ptr<CompoundTag> readData(std::vector<unsigned char>& data);
 
+//! @brief Deserializes a sequence of bytes into a NBT CompoundTag.
+//! @param data Sequence of bytes to be deserialized.
+//! @param options Settings of the created tags.
+//! @return CompoudTag with all contents.
+//! @throws std::runtime_error If the data is not valid NBT data.
+std::unique_ptr<CompoundTag> readData(std::vector<unsigned char>& data,
+                                      const ReadOptions& options);
+
 //! @brief Serializes a NBT tag into a sequence of bytes.
 //! @param tag The tag to be serialized.
 //! @return Serialized sequence of bytes.
@@ -1,37 +1,106 @@
 #ifndef CPP_ANVIL_NBT_LIST_TAG_HPP
 #define CPP_ANVIL_NBT_LIST_TAG_HPP
 
-#include "cpp-anvil/nbt/collection_tag.hpp"
+#include "cpp-anvil/nbt/basic_tag.hpp"
 #include "cpp-anvil/nbt/types.hpp"
 
+#include <concepts>
+#include <span>
 #include <stdexcept>
+#include <type_traits>
+#include <variant>
 
 namespace anvil {
 
-class ListTag : public CollectionTag<std::unique_ptr<BasicTag>, TagType::List>
+//! @brief Value types of lists that can be stored packed, see @ref ListTag.
+template<typename T>
+concept PackableListType = std::same_as<T, ByteType> || std::same_as<T, ShortType>
+                           || std::same_as<T, IntType> || std::same_as<T, LongType>
+                           || std::same_as<T, FloatType> || std::same_as<T, DoubleType>;
+
+namespace detail {
+
+//! @brief Returns the tag type of the elements of packed lists with values of type @p T.
+template<PackableListType T>
+constexpr TagType listTypeOf()
+{
+    if constexpr(std::same_as<T, ByteType>) {
+        return TagType::Byte;
+    } else if constexpr(std::same_as<T, ShortType>) {
+        return TagType::Short;
+    } else if constexpr(std::same_as<T, IntType>) {
+        return TagType::Int;
+    } else if constexpr(std::same_as<T, LongType>) {
+        return TagType::Long;
+    } else if constexpr(std::same_as<T, FloatType>) {
+        return TagType::Float;
+    } else {
+        return TagType::Double;
+    }
+}
+
+} // namespace detail
+
+//! @brief Tag containing unnamed tags of the same type.
+//! @details
+//! The elements of a list are stored in one of two ways:
+//! - As tags, which are accessed with the tag interface, e.g. value(), begin() or at().
+//! - Packed, as a contiguous vector of numbers without a tag per element. The values are accessed
+//!   with values<T>(), appendValue() and setValues(). @ref readData() creates packed lists for all
+//!   numeric element types if @ref ReadOptions::packLists is set.
+//!
+//! Lists are only packed on request: by pack(), setValues(), appendValue() or @ref readData(). The
+//! tag interface throws for packed lists and values<T>() throws for lists of tags, call pack() or
+//! unpack() to convert a list explicitly. size(), clear(), eraseAt(), swap(), reserve() and
+//! push_back() of a matching primitive tag work for both.
+class ListTag : public BasicTag
 {
 public:
-    ListTag()                         = default;
-    ListTag(const ListTag& other)     = default;
+    using value_type      = std::unique_ptr<BasicTag>;
+    using size_type       = typename ContainerType<value_type>::size_type;
+    using difference_type = typename ContainerType<value_type>::difference_type;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+
+    using iterator       = typename ContainerType<value_type>::iterator;
+    using const_iterator = typename ContainerType<value_type>::const_iterator;
+
+    using reverse_iterator       = typename ContainerType<value_type>::reverse_iterator;
+    using const_reverse_iterator = typename ContainerType<value_type>::const_reverse_iterator;
+
+    enum
+    {
+        Type = static_cast<int>(TagType::List)
+    };
+
+public:
+    ListTag() = default;
+    ListTag(const ListTag& other);
     ListTag(ListTag&& other) noexcept = default;
     explicit ListTag(const std::string& name)
-        : CollectionTag(name)
+        : BasicTag(name)
     { }
     explicit ListTag(const std::string& name, TagType listTagType)
-        : CollectionTag(name)
+        : BasicTag(name)
         , m_listType(listTagType)
     { }
     explicit ListTag(const ContainerType<value_type>& value)
-        : CollectionTag(value)
-    { }
+        : BasicTag()
+    {
+        copy(value);
+    }
     explicit ListTag(const std::string& name, const ContainerType<value_type>& value) noexcept
-        : CollectionTag(name, value)
-    { }
+        : BasicTag(name)
+    {
+        copy(value);
+    }
     virtual ~ListTag() = default;
 
-    ListTag& operator=(const ListTag& other)     = default;
+    ListTag& operator=(const ListTag& other);
     ListTag& operator=(ListTag&& other) noexcept = default;
 
+    constexpr virtual TagType type() const override { return TagType::List; }
+
     virtual std::unique_ptr<BasicTag> clone() const override
     {
         return std::make_unique<ListTag>(*this);
@@ -39,24 +108,189 @@ public:
 
     constexpr TagType listType() const { return m_listType; }
 
+    // Representation
+
+    //! @brief Checks if the list is stored packed.
+    //! @return `true` if the values are stored packed, `false` if the elements are tags.
+    bool isPacked() const { return m_elements.index() != 0; }
+
+    //! @brief Stores the list packed, if the element type is a number type.
+    //! @return `true` if the list is packed, `false` if the element type can not be packed.
+    bool pack();
+
+    //! @brief Stores the elements of the list as tags.
+    void unpack();
+
+    // Packed values
+
+    //! @brief Returns the values of a packed list.
+    //! @tparam T Value type, must match the list type.
+    //! @return The values.
+    //! @throws std::runtime_error If the list is not packed or the list type does not match @p T.
+    template<PackableListType T>
+    std::span<T> values()
+    {
+        return packedValues<T>();
+    }
+
+    //! @brief Returns the values of a packed list.
+    //! @tparam T Value type, must match the list type.
+    //! @return The values.
+    //! @throws std::runtime_error If the list is not packed or the list type does not match @p T.
+    template<PackableListType T>
+    std::span<const T> values() const
+    {
+        return const_cast<ListTag*>(this)->packedValues<T>();
+    }
+
+    //! @brief Replaces the list by the packed @p values.
+    //! @tparam T Value type, which determines the list type.
+    //! @param values The values.
+    template<PackableListType T>
+    void setValues(std::span<const T> values)
+    {
+        m_listType = detail::listTypeOf<T>();
+        m_elements = ContainerType<T>(values.begin(), values.end());
+    }
+
+    //! @brief Appends a value to a packed list. Empty lists are packed with the type of the value.
+    //! @tparam T Value type, must match the list type.
+    //! @param value The value.
+    //! @return `true` if the value was appended, `false` if the list is not packed with type @p T.
+    template<PackableListType T>
+    bool appendValue(T value)
+    {
+        if(empty() && (m_listType != detail::listTypeOf<T>() || !isPacked())) {
+            setValues<T>({});
+        }
+        if(auto* values = std::get_if<ContainerType<T>>(&m_elements)) {
+            values->push_back(value);
+            return true;
+        }
+        return false;
+    }
+
+    //! @brief Calls @p visitor with the values of a packed list as `std::span<const T>`.
+    //! @param visitor Callable accepting spans of all packable value types.
+    //! @return `true` if the list is packed, `false` if @p visitor was not called.
+    template<typename Visitor>
+    bool visitValues(Visitor&& visitor) const
+    {
+        return std::visit(
+            [&visitor]<typename Values>(const Values& values) {
+                if constexpr(std::is_same_v<Values, ContainerType<value_type>>) {
+                    return false;
+                } else {
+                    visitor(std::span<const typename Values::value_type>(values));
+                    return true;
+                }
+            },
+            m_elements);
+    }
+
+    // Tags
+
+    //! @brief Returns the tags of the list.
+    //! @return The tags.
+    //! @throws std::runtime_error If the list is packed.
+    ContainerType<value_type>& value() { return tags(); }
+
+    //! @brief Returns the tags of the list.
+    //! @return The tags.
+    //! @throws std::runtime_error If the list is packed.
+    const ContainerType<value_type>& value() const { return const_cast<ListTag*>(this)->tags(); }
+
+    void setValue(const ContainerType<value_type>& value) { copy(value); }
+    void copy(const ContainerType<value_type>& otherValue);
+
+    size_t indexOf(BasicTag* value) const;
+
+    // Iterators
+    iterator begin() { return value().begin(); }
+    const_iterator begin() const { return value().begin(); }
+    const_iterator cbegin() const { return value().cbegin(); }
+
+    iterator end() { return value().end(); }
+    const_iterator end() const { return value().end(); }
+    const_iterator cend() const { return value().cend(); }
+
+    reverse_iterator rbegin() { return value().rbegin(); }
+    const_reverse_iterator rbegin() const { return value().rbegin(); }
+    const_reverse_iterator crbegin() const { return value().crbegin(); }
+
+    reverse_iterator rend() { return value().rend(); }
+    const_reverse_iterator rend() const { return value().rend(); }
+    const_reverse_iterator crend() const { return value().crend(); }
+
+    // Element access
+    reference at(size_type pos) { return value().at(pos); }
+    const_reference at(const size_type pos) const { return value().at(pos); }
+
+    reference operator[](size_type pos) { return value()[pos]; }
+    const_reference operator[](size_type pos) const { return value()[pos]; }
+
+    reference front() { return value().front(); }
+    const_reference front() const { return value().front(); }
+
+    reference back() { return value().back(); }
+    const_reference back() const { return value().back(); }
+
+    // Capacity
+    bool empty() const { return size() == 0; }
+    size_type size() const;
+
+    //! @brief Reserves memory for @p capacity elements, values for packed lists, tags otherwise.
+    //! @param capacity Number of elements.
+    void reserve(size_type capacity);
+
+    // Modifiers
+    void clear();
+
     bool push_back(std::unique_ptr<BasicTag> value);
     bool push_back(BasicTag* value);
     bool push_back(const BasicTag& value);
 
+    bool eraseAt(size_type index);
+
+    void swap(size_t indexA, size_t indexB);
+
     std::unique_ptr<BasicTag> takeAt(size_type index);
     std::unique_ptr<BasicTag> take(BasicTag* tag);
 
     bool erase(BasicTag* tag);
 
 protected:
-    virtual bool isEqual(const BasicTag& other) const override
+    virtual bool isEqual(const BasicTag& other) const override;
+
+private:
+    using Elements =
+        std::variant<ContainerType<value_type>, ContainerType<ByteType>, ContainerType<ShortType>,
+                     ContainerType<IntType>, ContainerType<LongType>, ContainerType<FloatType>,
+                     ContainerType<DoubleType>>;
+
+    //! @brief Returns the tags, throws if the list is packed.
+    ContainerType<value_type>& tags();
+
+    //! @brief Returns the packed values, throws if the list is not packed with type @p T.
+    template<PackableListType T>
+    ContainerType<T>& packedValues()
     {
-        const ListTag& otherTag = static_cast<const ListTag&>(other);
-        return m_listType == otherTag.m_listType && CollectionTag::isEqual(other);
+        if(auto* values = std::get_if<ContainerType<T>>(&m_elements)) {
+            return *values;
+        }
+        throw std::runtime_error(isPacked() ? "Invalid list type." : "List is not packed.");
     }
 
+    //! @brief Appends the value of the primitive tag @p value to a packed list.
+    bool appendTagValue(const BasicTag& value);
+
+    //! @brief Packs the tags, if all of them are of type @p T.
+    template<PackableListType T>
+    bool packAs();
+
 private:
     TagType m_listType{TagType::End};
+    Elements m_elements; // Tags or packed values, see isPacked()
 };
 
 } // namespace anvil
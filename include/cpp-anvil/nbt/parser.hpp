@@ -0,0 +1,108 @@
+#ifndef CPP_ANVIL_NBT_PARSER_HPP
+#define CPP_ANVIL_NBT_PARSER_HPP
+
+#include "cpp-anvil/nbt/types.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace anvil {
+
+//! @brief Receives the events of @ref parseData().
+//! @details
+//! The parser calls the handler for every tag in the order of the serialized data. Compounds and
+//! lists are reported by a begin and an end event, the events of their children are called in
+//! between. Children of lists do not have names, their name is empty.
+//!
+//! Names, strings and arrays are only valid during the call, copy them if they are needed later.
+//! All functions do nothing by default, so a handler only needs to override the events it is
+//! interested in.
+class NbtHandler
+{
+public:
+    virtual ~NbtHandler() = default;
+
+    //! @brief Called for a CompoundTag before its children.
+    //! @param name Name of the tag.
+    virtual void beginCompound(std::string_view name);
+
+    //! @brief Called for a CompoundTag after its children.
+    virtual void endCompound();
+
+    //! @brief Called for a ListTag before its elements.
+    //! @param name Name of the tag.
+    //! @param elementType Type of the elements.
+    //! @param size Number of elements.
+    virtual void beginList(std::string_view name, TagType elementType, size_t size);
+
+    //! @brief Called for a ListTag after its elements.
+    virtual void endList();
+
+    //! @brief Called for a ByteTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, ByteType value);
+
+    //! @brief Called for a ShortTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, ShortType value);
+
+    //! @brief Called for an IntTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, IntType value);
+
+    //! @brief Called for a LongTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, LongType value);
+
+    //! @brief Called for a FloatTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, FloatType value);
+
+    //! @brief Called for a DoubleTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, DoubleType value);
+
+    //! @brief Called for a StringTag.
+    //! @param name Name of the tag.
+    //! @param value Value of the tag.
+    virtual void value(std::string_view name, std::string_view value);
+
+    //! @brief Called for a ByteArrayTag.
+    //! @param name Name of the tag.
+    //! @param values Values of the tag.
+    virtual void array(std::string_view name, std::span<const ByteType> values);
+
+    //! @brief Called for an IntArrayTag.
+    //! @param name Name of the tag.
+    //! @param values Values of the tag, converted to native byte order.
+    virtual void array(std::string_view name, std::span<const IntType> values);
+
+    //! @brief Called for a LongArrayTag.
+    //! @param name Name of the tag.
+    //! @param values Values of the tag, converted to native byte order.
+    virtual void array(std::string_view name, std::span<const LongType> values);
+};
+
+//! @brief Parses NBT data and reports the tags to @p handler.
+//! @details
+//! In contrast to @ref readData() no tags are created. The data is processed in a single pass and
+//! the only memory allocated is a buffer for converting int and long arrays, so data can be
+//! extracted without building the whole tree.
+//!
+//! @param data NBT data starting with a CompoundTag.
+//! @param handler The handler receiving the events.
+//! @throws std::runtime_error If the data is not valid NBT data. Events may have been reported
+//!                            until the error was found.
+void parseData(const std::vector<unsigned char>& data, NbtHandler& handler);
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_NBT_PARSER_HPP
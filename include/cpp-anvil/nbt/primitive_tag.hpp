@@ -3,6 +3,7 @@
 
 #include "cpp-anvil/nbt/basic_tag.hpp"
 #include "cpp-anvil/nbt/detail/floating_point.hpp"
+#include "cpp-anvil/nbt/detail/type_utilities.hpp"
 #include "cpp-anvil/nbt/types.hpp"
 
 namespace anvil {
@@ -0,0 +1,163 @@
+#ifndef CPP_ANVIL_NBT_TAG_ARENA_HPP
+#define CPP_ANVIL_NBT_TAG_ARENA_HPP
+
+#include "cpp-anvil/nbt/basic_tag.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace anvil {
+
+namespace detail {
+
+template<typename T>
+class ArenaTag;
+
+} // namespace detail
+
+//! @brief Monotonic memory for the tags of a tree.
+//! @details
+//! Tags created with @ref make() are placed in the arena by a pointer increment. @ref readData()
+//! creates all tags of a tree this way while a @ref TagArena::Scope is active, tags created with
+//! `new` or `std::make_unique` are never placed in an arena and have no overhead.
+//!
+//! The arena only holds the tag objects, their strings and arrays are allocated as usual. Deleting
+//! a tag runs its destructor but does not free its memory. The arena consists of blocks of
+//! @ref BlockSize bytes, a block is freed when the arena and all tags in the block are destroyed.
+//! Tags may therefore outlive the arena object and can be moved into other trees, each of them
+//! keeps only its own block alive. @ref estimateTagMemory() counts every block that a tree uses.
+//!
+//! Allocating from an arena is not thread-safe, but tags of an arena may be deleted from any
+//! thread.
+//!
+//! @code
+//! TagArena arena;
+//! std::unique_ptr<CompoundTag> root;
+//! {
+//!     TagArena::Scope scope(arena);
+//!     root = readData(data);
+//! }
+//! @endcode
+class TagArena
+{
+public:
+    //! @brief Size and alignment of the blocks of an arena.
+    constexpr static size_t BlockSize{64u * 1024u};
+
+    //! @brief Makes an arena the target of the tags created by @ref readData() in this thread.
+    //! @details
+    //! Scopes can be nested, the previous arena is restored when the scope ends. The arena must
+    //! outlive the scope.
+    class Scope
+    {
+    public:
+        //! @brief Starts allocating tags from @p arena.
+        //! @param arena The arena.
+        explicit Scope(TagArena& arena);
+
+        //! @brief Restores the previous arena.
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        TagArena* m_previous;
+    };
+
+public:
+    //! @brief Creates an empty arena.
+    TagArena() = default;
+
+    //! @brief Releases the arena. Each block is freed after the last of its tags is deleted.
+    ~TagArena();
+
+    TagArena(const TagArena&)            = delete;
+    TagArena& operator=(const TagArena&) = delete;
+
+    //! @brief Returns the arena of the innermost scope of the current thread.
+    //! @return The arena, `nullptr` if no scope is active.
+    static TagArena* current() noexcept;
+
+    //! @brief Creates a tag in the arena.
+    //! @tparam T Type of the tag.
+    //! @param args Arguments of the constructor of @p T.
+    //! @return The tag, which returns its memory to the arena when it is deleted.
+    template<typename T, typename... Args>
+    std::unique_ptr<T> make(Args&&... args)
+    {
+        return std::unique_ptr<T>(new(*this) detail::ArenaTag<T>(std::forward<Args>(args)...));
+    }
+
+    //! @brief Returns the memory reserved by the arena.
+    //! @return Size of all blocks of the arena in bytes, including freed blocks.
+    size_t reservedMemory() const { return m_reserved; }
+
+    //! @brief Checks if a tag was allocated from an arena.
+    //! @param tag The tag.
+    //! @return `true` if the tag is in an arena, `false` otherwise.
+    static bool isArenaAllocated(const BasicTag* tag) { return blockOf(tag) != nullptr; }
+
+    //! @brief Returns the block of an arena tag.
+    //! @param tag The tag.
+    //! @return Address of the block, `nullptr` if the tag is not in an arena.
+    static const void* blockOf(const BasicTag* tag);
+
+private:
+    template<typename T>
+    friend class detail::ArenaTag;
+
+    struct Block;
+
+    void* allocate(size_t size, size_t alignment);
+    static void deallocate(void* ptr) noexcept;
+
+    static Block* blockAt(const void* ptr) noexcept;
+    static void freeBlock(Block* block) noexcept;
+
+    //! @brief Gives up the current block, it is freed when its tags are deleted.
+    void retireBlock() noexcept;
+
+private:
+    Block* m_block{nullptr};
+    std::byte* m_position{nullptr};
+    std::byte* m_end{nullptr};
+    size_t m_blockTags{0}; // Tags allocated from the current block
+    size_t m_reserved{0};
+};
+
+namespace detail {
+
+//! @brief Tag of type @p T allocated from a @ref TagArena, created by @ref TagArena::make().
+template<typename T>
+class ArenaTag final : public T
+{
+public:
+    using T::T;
+
+    ArenaTag(const T& other)
+        : T(other)
+    { }
+
+    static void* operator new(std::size_t size, TagArena& arena)
+    {
+        static_assert(sizeof(ArenaTag) <= TagArena::BlockSize / 16, "Tag is too large for arenas.");
+        return arena.allocate(size, alignof(ArenaTag));
+    }
+
+    //! @brief Releases the memory if the constructor throws.
+    static void operator delete(void* ptr, TagArena&) noexcept { TagArena::deallocate(ptr); }
+
+    static void operator delete(void* ptr) noexcept { TagArena::deallocate(ptr); }
+
+private:
+    virtual bool isArenaAllocated() const noexcept override { return true; }
+};
+
+} // namespace detail
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_NBT_TAG_ARENA_HPP
@@ -0,0 +1,345 @@
+#ifndef CPP_ANVIL_NBT_VIEW_HPP
+#define CPP_ANVIL_NBT_VIEW_HPP
+
+#include "cpp-anvil/nbt/types.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+
+namespace anvil {
+
+class NbtCompoundView;
+class NbtListView;
+
+template<typename T>
+class NbtArrayView;
+
+//! @brief Read-only view of a tag within serialized NBT data.
+//! @details
+//! In contrast to the tags created by @ref readData(), a view does not copy anything. It points
+//! into the serialized data, which must outlive all views created from it. Names and strings are
+//! returned as views into the data and numbers are converted from big endian when they are
+//! accessed. Looking up tags does not allocate memory.
+//!
+//! The data is only checked when it is accessed. Accessing data beyond the end of the buffer
+//! throws a std::runtime_error.
+//!
+//! @code
+//! NbtView root = viewData(chunkData);
+//! int32_t xPos = root.asCompound()["xPos"].asInt();
+//! @endcode
+class NbtView
+{
+public:
+    //! @brief Creates an invalid view.
+    NbtView() = default;
+
+    //! @brief Returns the type of the tag.
+    //! @return The tag type, TagType::End for invalid views.
+    TagType type() const;
+
+    //! @brief Checks if the view points to a tag.
+    //! @return `true` if the view is valid, `false` if it is empty, e.g. a tag that was not found.
+    bool isValid() const;
+
+    //! @brief Checks if the view points to a tag.
+    //! @return `true` if the view is valid, `false` otherwise.
+    explicit operator bool() const;
+
+    //! @brief Returns the value of a ByteTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not a ByteTag.
+    ByteType asByte() const;
+
+    //! @brief Returns the value of a ShortTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not a ShortTag.
+    ShortType asShort() const;
+
+    //! @brief Returns the value of an IntTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not an IntTag.
+    IntType asInt() const;
+
+    //! @brief Returns the value of a LongTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not a LongTag.
+    LongType asLong() const;
+
+    //! @brief Returns the value of a FloatTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not a FloatTag.
+    FloatType asFloat() const;
+
+    //! @brief Returns the value of a DoubleTag.
+    //! @return The value.
+    //! @throws std::runtime_error If the tag is not a DoubleTag.
+    DoubleType asDouble() const;
+
+    //! @brief Returns the value of a StringTag.
+    //! @return View of the string in the serialized data.
+    //! @throws std::runtime_error If the tag is not a StringTag.
+    std::string_view asString() const;
+
+    //! @brief Returns the view of a CompoundTag.
+    //! @return The compound view.
+    //! @throws std::runtime_error If the tag is not a CompoundTag.
+    NbtCompoundView asCompound() const;
+
+    //! @brief Returns the view of a ListTag.
+    //! @return The list view.
+    //! @throws std::runtime_error If the tag is not a ListTag.
+    NbtListView asList() const;
+
+    //! @brief Returns the view of a ByteArrayTag.
+    //! @return The array view.
+    //! @throws std::runtime_error If the tag is not a ByteArrayTag.
+    NbtArrayView<ByteType> asByteArray() const;
+
+    //! @brief Returns the view of an IntArrayTag.
+    //! @return The array view.
+    //! @throws std::runtime_error If the tag is not an IntArrayTag.
+    NbtArrayView<IntType> asIntArray() const;
+
+    //! @brief Returns the view of a LongArrayTag.
+    //! @return The array view.
+    //! @throws std::runtime_error If the tag is not a LongArrayTag.
+    NbtArrayView<LongType> asLongArray() const;
+
+private:
+    friend class NbtCompoundView;
+    friend class NbtListView;
+    friend NbtView viewData(std::span<const unsigned char> data);
+
+    NbtView(TagType type, const unsigned char* data, const unsigned char* end);
+
+    //! @brief Returns the payload, checking the tag type and that @p size bytes are available.
+    const unsigned char* payload(TagType type, size_t size) const;
+
+private:
+    TagType m_type{TagType::End};
+    const unsigned char* m_data{nullptr};
+    const unsigned char* m_end{nullptr};
+};
+
+//! @brief Read-only view of a CompoundTag within serialized NBT data.
+//! @details
+//! Tags are found by walking over the serialized children, lookups are linear in the number of
+//! children before the found one.
+class NbtCompoundView
+{
+public:
+    //! @brief A named child of the compound.
+    struct Entry
+    {
+        std::string_view name;
+        NbtView value;
+    };
+
+    //! @brief Iterates over the children of the compound in serialized order.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = Entry;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const Entry*;
+        using reference         = const Entry&;
+
+        Iterator() = default;
+
+        reference operator*() const { return m_entry; }
+        pointer operator->() const { return &m_entry; }
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& other) const { return m_position == other.m_position; }
+
+    private:
+        friend class NbtCompoundView;
+
+        Iterator(const unsigned char* position, const unsigned char* end);
+
+        //! @brief Reads the entry at the current position, or ends the iteration at an EndTag.
+        void readEntry();
+
+    private:
+        const unsigned char* m_position{nullptr};
+        const unsigned char* m_end{nullptr};
+        Entry m_entry;
+    };
+
+public:
+    NbtCompoundView() = default;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    //! @brief Finds a child by its name.
+    //! @param name Name of the child.
+    //! @return View of the child, invalid if there is no child with that name.
+    NbtView find(std::string_view name) const;
+
+    //! @brief Finds a child by its name.
+    //! @param name Name of the child.
+    //! @return View of the child, invalid if there is no child with that name.
+    NbtView operator[](std::string_view name) const;
+
+    //! @brief Checks if there is a child with the given name.
+    //! @param name Name of the child.
+    //! @return `true` if the child exists, `false` otherwise.
+    bool contains(std::string_view name) const;
+
+    //! @brief Counts the children, which walks over all of them.
+    //! @return Number of children.
+    size_t size() const;
+
+private:
+    friend class NbtView;
+
+    NbtCompoundView(const unsigned char* data, const unsigned char* end);
+
+private:
+    const unsigned char* m_data{nullptr};
+    const unsigned char* m_end{nullptr};
+};
+
+//! @brief Read-only view of a ListTag within serialized NBT data.
+//! @details
+//! Elements of lists with numeric element types are accessed in constant time, other elements
+//! are found by walking over the preceding elements.
+class NbtListView
+{
+public:
+    //! @brief Iterates over the elements of the list.
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = NbtView;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const NbtView*;
+        using reference         = const NbtView&;
+
+        Iterator() = default;
+
+        reference operator*() const { return m_value; }
+        pointer operator->() const { return &m_value; }
+
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        bool operator==(const Iterator& other) const { return m_remaining == other.m_remaining; }
+
+    private:
+        friend class NbtListView;
+
+        Iterator(TagType type, const unsigned char* position, const unsigned char* end,
+                 size_t remaining);
+
+    private:
+        NbtView m_value;
+        const unsigned char* m_end{nullptr};
+        size_t m_remaining{0};
+    };
+
+public:
+    NbtListView() = default;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+    //! @brief Returns the type of the elements.
+    //! @return The element type.
+    TagType elementType() const;
+
+    //! @brief Returns the number of elements.
+    //! @return Number of elements.
+    size_t size() const;
+
+    //! @brief Checks if the list is empty.
+    //! @return `true` if the list has no elements, `false` otherwise.
+    bool empty() const;
+
+    //! @brief Returns the element at @p index.
+    //! @param index Index of the element.
+    //! @return View of the element.
+    //! @throws std::out_of_range If index is out of range.
+    NbtView operator[](size_t index) const;
+
+private:
+    friend class NbtView;
+
+    NbtListView(TagType elementType, size_t size, const unsigned char* data,
+                const unsigned char* end);
+
+private:
+    TagType m_elementType{TagType::End};
+    size_t m_size{0};
+    const unsigned char* m_data{nullptr};
+    const unsigned char* m_end{nullptr};
+};
+
+//! @brief Read-only view of an array tag within serialized NBT data.
+//! @details
+//! The values are converted from big endian when they are accessed.
+//!
+//! @tparam T Value type, ByteType, IntType or LongType.
+template<typename T>
+class NbtArrayView
+{
+public:
+    NbtArrayView() = default;
+
+    //! @brief Returns the number of values.
+    //! @return Number of values.
+    size_t size() const { return m_size; }
+
+    //! @brief Checks if the array is empty.
+    //! @return `true` if the array has no values, `false` otherwise.
+    bool empty() const { return m_size == 0; }
+
+    //! @brief Returns the value at @p index.
+    //! @param index Index of the value, not checked.
+    //! @return The value.
+    T operator[](size_t index) const;
+
+    //! @brief Returns the value at @p index.
+    //! @param index Index of the value.
+    //! @return The value.
+    //! @throws std::out_of_range If index is out of range.
+    T at(size_t index) const;
+
+    //! @brief Returns the serialized big endian values.
+    //! @return View of the values in the serialized data.
+    std::span<const unsigned char> bytes() const { return {m_data, m_size * sizeof(T)}; }
+
+private:
+    friend class NbtView;
+
+    NbtArrayView(const unsigned char* data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    { }
+
+private:
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+};
+
+//! @brief Creates a view of serialized NBT data.
+//! @details
+//! The first tag in the data must be a CompoundTag, see @ref readData(). The data must outlive
+//! the returned view and all views created from it.
+//!
+//! @param data Serialized NBT data.
+//! @return View of the root CompoundTag.
+//! @throws std::runtime_error If the data does not start with a CompoundTag.
+NbtView viewData(std::span<const unsigned char> data);
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_NBT_VIEW_HPP
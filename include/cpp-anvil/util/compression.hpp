@@ -1,7 +1,10 @@
 #ifndef CPP_ANVIL_IO_COMPRESSION_HPP
 #define CPP_ANVIL_IO_COMPRESSION_HPP
 
+#include <cstddef>
 #include <fstream>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace anvil {
@@ -12,6 +15,7 @@ enum class CompressionType : char
     Gzip         = 1,
     Zlib         = 2,
     Uncompressed = 3,
+    Lz4          = 4,
 };
 
 enum CompressionLevel : char
@@ -40,19 +44,172 @@ constexpr bool isZlibCompressed(const std::vector<unsigned char>& data)
             && (data[1] == 0x8B || data[1] == 0x5E || data[1] == 0x9C || data[1] == 0xDA));
 }
 
-//! @brief Checks if sequence of bytes begins with neither Zlib or Gzip header.
+//! @brief Checks if sequence of bytes begins with the magic of a LZ4 block stream.
 //! @param data The data to be checked.
-//! @return `true` if the first 2 bytes do not indicate Gzip or Zlib header, `false` otherwise.
+//! @return `true` if the first 8 bytes are `LZ4Block`, `false` otherwise.
+constexpr bool isLz4Compressed(const std::vector<unsigned char>& data)
+{
+    constexpr char magic[] = "LZ4Block";
+    if(data.size() < 8) {
+        return false;
+    }
+    for(size_t i = 0; i < 8; ++i) {
+        if(data[i] != static_cast<unsigned char>(magic[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! @brief Checks if sequence of bytes begins with neither Zlib, Gzip or LZ4 header.
+//! @param data The data to be checked.
+//! @return `true` if the first bytes do not indicate a Gzip, Zlib or LZ4 header, `false`
+//!         otherwise.
 constexpr bool isUncompressed(const std::vector<unsigned char>& data)
 {
-    return !isGzipCompressed(data) && !isZlibCompressed(data);
+    return !isGzipCompressed(data) && !isZlibCompressed(data) && !isLz4Compressed(data);
 }
 
-//! @brief Tests type of compression of the data sequence by looking for Gzip or Zlib header.
+//! @brief Tests type of compression of the data sequence by looking for Gzip, Zlib or LZ4 header.
 //! @param data The data to be checked.
 //! @return CompressionType of data sequence.
 CompressionType testCompression(const std::vector<unsigned char>& data);
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compression contexts
+
+//! @brief Statistics of an @ref Inflater.
+//! @details
+//! Only gzip and zlib buffers are counted.
+struct InflateStats
+{
+    //! Number of uncompressed buffers.
+    size_t buffers{0};
+    //! Number of buffers with a size hint, passed by the caller or read from the gzip trailer.
+    size_t hintedBuffers{0};
+    //! Number of buffers whose size hint matched the uncompressed size exactly.
+    size_t exactHints{0};
+    //! Number of times the output buffer had to grow.
+    size_t reallocations{0};
+    //! Number of times the output buffer would have grown without the size hints.
+    size_t avoidedReallocations{0};
+};
+
+//! @brief Reusable context to uncompress data.
+//! @details
+//! Setting up a zlib stream allocates its window and internal state. An inflater keeps this state
+//! and only resets it between buffers, which saves the setup when many small buffers like chunks
+//! are uncompressed. An inflater must not be used by multiple threads at once, use
+//! @ref threadLocal() to get one for the calling thread.
+class Inflater
+{
+public:
+    Inflater();
+    ~Inflater();
+
+    Inflater(const Inflater&)            = delete;
+    Inflater& operator=(const Inflater&) = delete;
+    Inflater(Inflater&&) noexcept;
+    Inflater& operator=(Inflater&&) noexcept;
+
+    //! @brief Returns the inflater of the calling thread.
+    //! @return The inflater, valid until the thread exits.
+    static Inflater& threadLocal();
+
+    //! @brief Returns the statistics of all buffers uncompressed so far.
+    //! @return The statistics.
+    const InflateStats& stats() const;
+
+    //! @brief Resets the statistics.
+    void resetStats();
+
+    //! @brief Uncompresses data into byte vector.
+    //! @details
+    //! The capacity of @p out is reused, so passing the same vector for many buffers avoids
+    //! allocations. If the uncompressed size is known or can be estimated, @p sizeHint avoids
+    //! growing the vector while uncompressing. Without a hint, the size of gzip data is taken
+    //! from its trailer.
+    //!
+    //! @param compression Compression type of @p in.
+    //! @param in View of compressed data.
+    //! @param out Output vector of uncompressed input data.
+    //! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+    //! @return `true` if uncompressing succeeded, `false` otherwise or if the compression type is
+    //!         not supported.
+    bool inflate(CompressionType compression, std::span<const unsigned char> in,
+                 std::vector<unsigned char>& out, size_t sizeHint = 0);
+
+    //! @brief Uncompresses data into byte vector.
+    //! @param compression Compression type of @p in.
+    //! @param in View of compressed data.
+    //! @param out Output vector of uncompressed input data.
+    //! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+    //! @return `true` if uncompressing succeeded, `false` otherwise or if the compression type is
+    //!         not supported.
+    bool inflate(CompressionType compression, std::span<const std::byte> in,
+                 std::vector<unsigned char>& out, size_t sizeHint = 0);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+//! @brief Reusable context to compress data.
+//! @details
+//! Like @ref Inflater, a deflater keeps its compression state and only resets it between buffers.
+//! A deflater must not be used by multiple threads at once, use @ref threadLocal() to get one for
+//! the calling thread.
+class Deflater
+{
+public:
+    //! @brief Creates a deflater.
+    //! @param compressionLevel The compression level.
+    explicit Deflater(int compressionLevel = DefaultCompression);
+    ~Deflater();
+
+    Deflater(const Deflater&)            = delete;
+    Deflater& operator=(const Deflater&) = delete;
+    Deflater(Deflater&&) noexcept;
+    Deflater& operator=(Deflater&&) noexcept;
+
+    //! @brief Returns the deflater of the calling thread.
+    //! @return The deflater, valid until the thread exits.
+    static Deflater& threadLocal();
+
+    //! @brief Returns the compression level.
+    //! @return The compression level.
+    int compressionLevel() const;
+
+    //! @brief Sets the compression level.
+    //! @details
+    //! Changing the compression level discards the compression state.
+    //!
+    //! @param compressionLevel The compression level.
+    void setCompressionLevel(int compressionLevel);
+
+    //! @brief Compresses data into byte vector.
+    //! @param compression The compression type.
+    //! @param in The input data sequence to be compressed.
+    //! @param out The output data sequence of compressed data.
+    //! @return `true` if compression succeeded, `false` otherwise or if the compression type is
+    //!         not supported.
+    bool deflate(CompressionType compression, std::span<const unsigned char> in,
+                 std::vector<unsigned char>& out);
+
+    //! @brief Compresses data into byte vector.
+    //! @param compression The compression type.
+    //! @param in The input data sequence to be compressed.
+    //! @param out The output data sequence of compressed data, its capacity is reused.
+    //! @return `true` if compression succeeded, `false` otherwise or if the compression type is
+    //!         not supported.
+    bool deflate(CompressionType compression, std::span<const std::byte> in,
+                 std::vector<unsigned char>& out);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // inflate / uncompress
 
@@ -69,6 +226,20 @@ bool inflate_gzip(std::ifstream& strm, std::vector<unsigned char>& data);
 //! @return `true` if uncompressing succeeded, `false` otherwise.
 bool inflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out);
 
+//! @brief Uncompresses gzip data sequence into byte vector.
+//! @param in View of gzip compressed data, e.g. a memory mapped file region.
+//! @param out Output vector of uncompressed input data.
+//! @return `true` if uncompressing succeeded, `false` otherwise.
+bool inflate_gzip(std::span<const unsigned char> in, std::vector<unsigned char>& out);
+
+//! @brief Uncompresses gzip data into a reused byte vector.
+//! @param in View of gzip compressed data.
+//! @param out Output vector of uncompressed input data. Its capacity is reused.
+//! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+//! @return `true` if uncompressing succeeded, `false` otherwise.
+bool inflate_gzip(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  size_t sizeHint = 0);
+
 //! @brief Uncompresses zlib data stream into byte vector.
 //! @param strm The stream to read compressed data bytes from.
 //! @param data The target container to write the uncompressed data to. The container will be
@@ -82,6 +253,50 @@ bool inflate_zlib(std::ifstream& strm, std::vector<unsigned char>& data);
 //! @return `true` if uncompressing succeeded, `false` otherwise.
 bool inflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out);
 
+//! @brief Uncompresses zlib data sequence into byte vector.
+//! @param in View of zlib compressed data, e.g. a memory mapped file region.
+//! @param out Output vector of uncompressed input data.
+//! @return `true` if uncompressing succeeded, `false` otherwise.
+bool inflate_zlib(std::span<const unsigned char> in, std::vector<unsigned char>& out);
+
+//! @brief Uncompresses zlib data into a reused byte vector.
+//! @param in View of zlib compressed data.
+//! @param out Output vector of uncompressed input data. Its capacity is reused.
+//! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+//! @return `true` if uncompressing succeeded, `false` otherwise.
+bool inflate_zlib(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  size_t sizeHint = 0);
+
+//! @brief Checks if the library has been built with LZ4 support.
+//! @return `true` if LZ4 data can be compressed and uncompressed, `false` otherwise.
+bool isLz4Supported();
+
+//! @brief Uncompresses a LZ4 block stream into byte vector.
+//! @details
+//! The data is expected in the block stream format of lz4-java, which is used for LZ4 compressed
+//! chunks of region files. Every block starts with the magic `LZ4Block`, followed by a token,
+//! the compressed and the uncompressed size and a XXH32 checksum of the uncompressed data. The
+//! stream must end with an empty block, streams without it and data following it are rejected.
+//!
+//! @param in Input vector of LZ4 compressed data.
+//! @param out Output vector of uncompressed input data.
+//! @return `true` if uncompressing succeeded, `false` otherwise or if LZ4 is not supported.
+bool inflate_lz4(const std::vector<unsigned char>& in, std::vector<unsigned char>& out);
+
+//! @brief Uncompresses a LZ4 block stream into byte vector.
+//! @param in View of LZ4 compressed data, e.g. a memory mapped file region.
+//! @param out Output vector of uncompressed input data.
+//! @return `true` if uncompressing succeeded, `false` otherwise or if LZ4 is not supported.
+bool inflate_lz4(std::span<const unsigned char> in, std::vector<unsigned char>& out);
+
+//! @brief Uncompresses a LZ4 block stream into a reused byte vector.
+//! @param in View of LZ4 compressed data.
+//! @param out Output vector of uncompressed input data. Its capacity is reused.
+//! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+//! @return `true` if uncompressing succeeded, `false` otherwise or if LZ4 is not supported.
+bool inflate_lz4(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                 size_t sizeHint = 0);
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // deflate / compress
 
@@ -101,6 +316,29 @@ bool deflate_gzip(std::ofstream& strm, std::vector<unsigned char>& data,
 bool deflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
                   const int compressionLevel = DefaultCompression);
 
+//! @brief Compresses data sequence with gzip compression algorithm.
+//! @param in View of the data to be compressed.
+//! @param out The output data sequence of compressed data. Its capacity is reused.
+//! @param compressionLevel The compression level.
+//! @return `true` if compression succeeded, `false` otherwise.
+bool deflate_gzip(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  const int compressionLevel = DefaultCompression);
+
+//! @brief Compresses data sequence with gzip compression algorithm on multiple threads.
+//! @details
+//! The data is split into blocks of 128 KiB that are compressed in parallel and joined into a
+//! single gzip stream, like pigz does. Every block is primed with the end of the previous block, so
+//! the compressed size is close to compressing at once. Data of a single block is compressed like
+//! @ref deflate_gzip() does.
+//!
+//! @param in The input data sequence to be compressed.
+//! @param out The output data sequence of compressed data.
+//! @param compressionLevel The compression level.
+//! @param threadCount Number of threads. `0` uses the hardware concurrency.
+//! @return `true` if compression succeeded, `false` otherwise.
+bool deflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
+                  const int compressionLevel, size_t threadCount);
+
 //! @brief Compresses data sequence with zlib compression algorithm.
 //! @param strm The stream where the compressed data is written to.
 //! @param data The input data sequence to be compressed.
@@ -119,6 +357,45 @@ bool deflate_zlib(std::ofstream& strm, std::vector<unsigned char>& data,
 bool deflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
                   const int compressionLevel = DefaultCompression);
 
+//! @brief Compresses data sequence with zlib compression algorithm.
+//! @param in View of the data to be compressed.
+//! @param out The output data sequence of compressed data. Its capacity is reused.
+//! @param compressionLevel The compression level.
+//! @return `true` if compression succeeded, `false` otherwise.
+bool deflate_zlib(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  const int compressionLevel = DefaultCompression);
+
+//! @brief Compresses data sequence with zlib compression algorithm on multiple threads.
+//! @details
+//! The data is split into blocks of 128 KiB that are compressed in parallel and joined into a
+//! single zlib stream, like pigz does. Every block is primed with the end of the previous block, so
+//! the compressed size is close to compressing at once. Data of a single block is compressed like
+//! @ref deflate_zlib() does.
+//!
+//! @param in The input data sequence to be compressed.
+//! @param out The output data sequence of compressed data.
+//! @param compressionLevel The compression level.
+//! @param threadCount Number of threads. `0` uses the hardware concurrency.
+//! @return `true` if compression succeeded, `false` otherwise.
+bool deflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
+                  const int compressionLevel, size_t threadCount);
+
+//! @brief Compresses data sequence into a LZ4 block stream.
+//! @details
+//! The data is split into blocks of 64 KiB, see @ref inflate_lz4() for the format. Blocks that
+//! do not shrink are stored uncompressed.
+//!
+//! @param in The input data sequence to be compressed.
+//! @param out The output data sequence of compressed data.
+//! @return `true` if compression succeeded, `false` otherwise or if LZ4 is not supported.
+bool deflate_lz4(const std::vector<unsigned char>& in, std::vector<unsigned char>& out);
+
+//! @brief Compresses data sequence into a LZ4 block stream.
+//! @param in View of the data to be compressed.
+//! @param out The output data sequence of compressed data. Its capacity is reused.
+//! @return `true` if compression succeeded, `false` otherwise or if LZ4 is not supported.
+bool deflate_lz4(std::span<const std::byte> in, std::vector<unsigned char>& out);
+
 } // namespace anvil
 
 #endif // CPP_ANVIL_IO_COMPRESSION_HPP
@@ -0,0 +1,77 @@
+#include "cpp-anvil/nbt/compound_tag.hpp"
+#include "cpp-anvil/nbt/io.hpp"
+#include "cpp-anvil/nbt/tag_arena.hpp"
+
+// Internal headers
+#include "anvil/chunk_codec.hpp"
+#include "util/byte_swap.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace anvil {
+
+std::span<const unsigned char> chunkSectorData(std::span<const unsigned char> sectors,
+                                               CompressionType& compression)
+{
+    if(sectors.size() < 5u) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
+
+    // Get size of binary data and compression type
+    uint32_t dataSize = 0;
+    std::memcpy(&dataSize, sectors.data(), sizeof(uint32_t));
+    dataSize = detail::swapEndian(dataSize);
+    if(dataSize == 0 || dataSize > sectors.size() - 4u) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
+
+    compression = static_cast<CompressionType>(sectors[4]);
+    return sectors.subspan(5u, dataSize - 1);
+}
+
+std::unique_ptr<CompoundTag> decodeChunk(CompressionType compression,
+                                         std::span<const unsigned char> data, size_t sizeHint,
+                                         size_t* uncompressedSize)
+{
+    // The buffer is reused for all chunks decoded by the same thread.
+    thread_local std::vector<unsigned char> chunkData;
+    Inflater& inflater = Inflater::threadLocal();
+    switch(compression) {
+        case CompressionType::Gzip:
+            if(!inflater.inflate(compression, data, chunkData, sizeHint)) {
+                throw std::runtime_error("Failed to uncompress chunk data (gzip).");
+            }
+            break;
+        case CompressionType::Zlib:
+            if(!inflater.inflate(compression, data, chunkData, sizeHint)) {
+                throw std::runtime_error("Failed to uncompress chunk data (zlib).");
+            }
+            break;
+        case CompressionType::Uncompressed:
+            chunkData.assign(data.begin(), data.end());
+            break;
+        case CompressionType::Lz4:
+            if(!isLz4Supported()) {
+                throw std::runtime_error("LZ4 compressed chunks are not supported by this build.");
+            }
+            if(!inflater.inflate(compression, data, chunkData, sizeHint)) {
+                throw std::runtime_error("Failed to uncompress chunk data (lz4).");
+            }
+            break;
+        default:
+            throw std::runtime_error("Unknown compression type.");
+    }
+
+    if(uncompressedSize != nullptr) {
+        *uncompressedSize = chunkData.size();
+    }
+
+    // The tags of the chunk are placed in arena blocks, each freed with the last of its tags.
+    TagArena arena;
+    TagArena::Scope scope(arena);
+    return readData(chunkData);
+}
+
+} // namespace anvil
@@ -0,0 +1,34 @@
+#ifndef CPP_ANVIL_ANVIL_CHUNK_CODEC_HPP
+#define CPP_ANVIL_ANVIL_CHUNK_CODEC_HPP
+
+#include "cpp-anvil/util/compression.hpp"
+
+#include <memory>
+#include <span>
+
+namespace anvil {
+
+class CompoundTag;
+
+//! @brief Splits the sectors of a chunk into compression type and compressed data.
+//! @param sectors Chunk sectors beginning with the 4 byte length, may be truncated after the data.
+//! @param compression Set to the compression type of the chunk.
+//! @return The compressed chunk data within @p sectors.
+//! @throws std::runtime_error If the length does not fit into @p sectors.
+std::span<const unsigned char> chunkSectorData(std::span<const unsigned char> sectors,
+                                               CompressionType& compression);
+
+//! @brief Uncompresses and parses the compressed data of a chunk.
+//! @param compression Compression type of @p data.
+//! @param data Compressed chunk data.
+//! @param sizeHint Expected size of the uncompressed data, `0` if unknown.
+//! @param uncompressedSize Set to the size of the uncompressed data, if not `nullptr`.
+//! @return Root tag of the chunk.
+//! @throws std::runtime_error If the data can not be uncompressed or parsed.
+std::unique_ptr<CompoundTag> decodeChunk(CompressionType compression,
+                                         std::span<const unsigned char> data, size_t sizeHint = 0,
+                                         size_t* uncompressedSize = nullptr);
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_ANVIL_CHUNK_CODEC_HPP
@@ -0,0 +1,458 @@
+#include "cpp-anvil/anvil/chunk_loader.hpp"
+#include "cpp-anvil/anvil/region.hpp"
+#include "cpp-anvil/nbt/compound_tag.hpp"
+
+// Internal headers
+#include "anvil/chunk_codec.hpp"
+#include "anvil/region_header.hpp"
+#include "util/blocking_queue.hpp"
+#include "util/parallel.hpp"
+#include "util/random_access_file.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(CPPANVIL_HAS_IO_URING)
+#include <liburing.h>
+#endif
+
+namespace anvil {
+
+namespace {
+
+//! @brief A region file opened for reading, shared by all reads of its chunks.
+struct RegionFile
+{
+    std::string filename;
+    RandomAccessFile file;
+};
+
+//! @brief A queued region file.
+struct RegionJob
+{
+    std::string filename;
+    std::vector<size_t> indices;
+};
+
+//! @brief The sectors of a chunk, read from a region file.
+struct ChunkRead
+{
+    std::shared_ptr<RegionFile> region;
+    size_t index{0};
+    size_t offset{0};
+    std::vector<unsigned char> data;
+    std::exception_ptr error;
+};
+
+} // namespace
+
+class ChunkLoader::Impl
+{
+public:
+    Impl(Callback callback, const Options& options);
+    ~Impl();
+
+    void load(RegionJob&& job);
+    void wait();
+
+    Backend backend() const { return m_backend; }
+
+private:
+    //! @brief Reads the header of a region file and creates the reads of its chunks.
+    //! @return The chunk reads, ordered by their offset in the file.
+    std::vector<std::unique_ptr<ChunkRead>> openRegion(const RegionJob& job) const;
+
+    //! @brief Opens the region and queues a failed read if this is not possible.
+    //! @return The chunk reads of the region.
+    std::vector<std::unique_ptr<ChunkRead>> startRegion(const RegionJob& job);
+
+    void runThreadPoolIo();
+#if defined(CPPANVIL_HAS_IO_URING)
+    void runIoUring();
+#endif
+    void runDecoder();
+
+    void addWork(size_t count);
+    void finishWork(size_t count);
+
+    Callback m_callback;
+    Backend m_backend{Backend::ThreadPool};
+    size_t m_queueDepth{1};
+
+    detail::BlockingQueue<RegionJob> m_regionQueue;
+    detail::BlockingQueue<std::unique_ptr<ChunkRead>> m_decodeQueue;
+
+    // Number of queued regions and chunks that have not been passed to the callback yet.
+    std::mutex m_workMutex;
+    std::condition_variable m_workDone;
+    size_t m_pendingWork{0};
+    std::exception_ptr m_callbackError;
+
+#if defined(CPPANVIL_HAS_IO_URING)
+    io_uring m_ring{};
+#endif
+
+    std::vector<std::thread> m_ioThreads;
+    std::vector<std::thread> m_decodeThreads;
+};
+
+ChunkLoader::Impl::Impl(Callback callback, const Options& options)
+    : m_callback(std::move(callback))
+    , m_queueDepth(std::max<size_t>(1u, options.queueDepth))
+    , m_decodeQueue(std::max<size_t>(1u, options.queueDepth))
+{
+    const size_t unlimited = std::numeric_limits<size_t>::max();
+
+#if defined(CPPANVIL_HAS_IO_URING)
+    // Fall back to the thread pool if the kernel does not provide io_uring.
+    if(options.useIoUring
+       && io_uring_queue_init(static_cast<unsigned>(std::min<size_t>(m_queueDepth, 4096u)),
+                              &m_ring, 0)
+              == 0) {
+        m_backend = Backend::IoUring;
+        m_ioThreads.emplace_back(&Impl::runIoUring, this);
+    }
+#endif
+    if(m_backend == Backend::ThreadPool) {
+        const size_t ioThreads = detail::resolveThreadCount(options.ioThreads, unlimited);
+        for(size_t i = 0; i < ioThreads; ++i) {
+            m_ioThreads.emplace_back(&Impl::runThreadPoolIo, this);
+        }
+    }
+
+    const size_t decodeThreads = detail::resolveThreadCount(options.decodeThreads, unlimited);
+    for(size_t i = 0; i < decodeThreads; ++i) {
+        m_decodeThreads.emplace_back(&Impl::runDecoder, this);
+    }
+}
+
+ChunkLoader::Impl::~Impl()
+{
+    // All regions are read before the decode queue is closed, so no chunk gets lost.
+    m_regionQueue.close();
+    for(auto& thread : m_ioThreads) {
+        thread.join();
+    }
+    m_decodeQueue.close();
+    for(auto& thread : m_decodeThreads) {
+        thread.join();
+    }
+
+#if defined(CPPANVIL_HAS_IO_URING)
+    if(m_backend == Backend::IoUring) {
+        io_uring_queue_exit(&m_ring);
+    }
+#endif
+}
+
+void ChunkLoader::Impl::load(RegionJob&& job)
+{
+    addWork(1);
+    m_regionQueue.push(std::move(job));
+}
+
+void ChunkLoader::Impl::wait()
+{
+    std::unique_lock<std::mutex> lock(m_workMutex);
+    m_workDone.wait(lock, [this]() { return m_pendingWork == 0; });
+    if(m_callbackError) {
+        std::rethrow_exception(std::exchange(m_callbackError, nullptr));
+    }
+}
+
+std::vector<std::unique_ptr<ChunkRead>> ChunkLoader::Impl::openRegion(const RegionJob& job) const
+{
+    auto region      = std::make_shared<RegionFile>();
+    region->filename = job.filename;
+    if(!region->file.open(job.filename)) {
+        throw std::runtime_error("Failed to open region file.");
+    }
+
+    const size_t fileSize = region->file.size();
+    std::vector<unsigned char> headerData(RegionHeader::HeaderSize);
+    RegionHeader header;
+    if(region->file.readAt(0, headerData.data(), headerData.size()) != headerData.size()
+       || !header.loadFromData(headerData)) {
+        throw std::runtime_error("Region file is too small to contain a valid header.");
+    }
+    // Chunks with invalid locations are skipped like chunks that are not stored.
+    header.clearInvalid(fileSize);
+
+    // Read the chunks in the order they are stored in the file.
+    std::vector<size_t> indices = job.indices;
+    indices.erase(std::remove_if(indices.begin(), indices.end(),
+                                 [&header](size_t index) { return header.empty(index); }),
+                  indices.end());
+    std::sort(indices.begin(), indices.end(), [&header](size_t lhs, size_t rhs) {
+        return header.offset(lhs) < header.offset(rhs);
+    });
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    std::vector<std::unique_ptr<ChunkRead>> reads;
+    reads.reserve(indices.size());
+    for(size_t index : indices) {
+        // The last sector may be truncated at the end of the file.
+        auto read    = std::make_unique<ChunkRead>();
+        read->region = region;
+        read->index  = index;
+        read->offset = header.byteOffset(index);
+        read->data.resize(std::min(header.byteSize(index), fileSize - read->offset));
+        reads.push_back(std::move(read));
+    }
+    return reads;
+}
+
+std::vector<std::unique_ptr<ChunkRead>> ChunkLoader::Impl::startRegion(const RegionJob& job)
+{
+    std::vector<std::unique_ptr<ChunkRead>> reads;
+    try {
+        reads = openRegion(job);
+    } catch(...) {
+        // The failed region is reported by the decode threads in place of its chunks.
+        auto read              = std::make_unique<ChunkRead>();
+        read->region           = std::make_shared<RegionFile>();
+        read->region->filename = job.filename;
+        read->index            = Region::Chunks;
+        read->error            = std::current_exception();
+        m_decodeQueue.push(std::move(read));
+        return {};
+    }
+
+    addWork(reads.size());
+    finishWork(1);
+    return reads;
+}
+
+void ChunkLoader::Impl::runThreadPoolIo()
+{
+    RegionJob job;
+    while(m_regionQueue.pop(job)) {
+        for(auto& read : startRegion(job)) {
+            try {
+                const size_t bytesRead =
+                    read->region->file.readAt(read->offset, read->data.data(), read->data.size());
+                read->data.resize(bytesRead);
+            } catch(...) {
+                read->error = std::current_exception();
+            }
+            m_decodeQueue.push(std::move(read));
+        }
+    }
+}
+
+#if defined(CPPANVIL_HAS_IO_URING)
+
+void ChunkLoader::Impl::runIoUring()
+{
+    std::deque<std::unique_ptr<ChunkRead>> queued;
+    std::vector<std::pair<io_uring_sqe*, ChunkRead*>> prepared;
+    size_t inFlight = 0;
+    size_t noOps    = 0;
+    bool closed     = false;
+
+    while(!closed || !queued.empty() || inFlight > 0) {
+        // Open further regions while there are free slots. Wait for new regions only if there is
+        // nothing else to do.
+        while(!closed && queued.size() < m_queueDepth) {
+            RegionJob job;
+            if(inFlight == 0 && queued.empty()) {
+                if(!m_regionQueue.pop(job)) {
+                    closed = true;
+                    break;
+                }
+            } else if(!m_regionQueue.tryPop(job)) {
+                break;
+            }
+            for(auto& read : startRegion(job)) {
+                queued.push_back(std::move(read));
+            }
+        }
+
+        // Submit reads until the ring is full.
+        prepared.clear();
+        while(!queued.empty() && inFlight + prepared.size() < m_queueDepth) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&m_ring);
+            if(sqe == nullptr) {
+                break;
+            }
+            ChunkRead* read = queued.front().release();
+            queued.pop_front();
+            io_uring_prep_read(sqe, read->region->file.nativeHandle(), read->data.data(),
+                               static_cast<unsigned>(read->data.size()), read->offset);
+            io_uring_sqe_set_data(sqe, read);
+            prepared.emplace_back(sqe, read);
+        }
+        if(!prepared.empty()) {
+            // No-ops left from a failed submission are ahead of the new reads.
+            const int submitted  = io_uring_submit(&m_ring);
+            const size_t taken   = submitted > 0 ? static_cast<size_t>(submitted) : 0;
+            const size_t skipped = std::min(taken, noOps);
+            const size_t started = std::min(taken - skipped, prepared.size());
+            noOps -= skipped;
+            inFlight += started;
+
+            // Reads the kernel did not take fail. Their entries become no-ops, so that a later
+            // submission does not reference them anymore.
+            for(size_t i = started; i < prepared.size(); ++i) {
+                ++noOps;
+                io_uring_prep_nop(prepared[i].first);
+                io_uring_sqe_set_data(prepared[i].first, nullptr);
+
+                std::unique_ptr<ChunkRead> read(prepared[i].second);
+                read->error =
+                    std::make_exception_ptr(std::runtime_error("Failed to submit file read."));
+                m_decodeQueue.push(std::move(read));
+            }
+        }
+        if(inFlight == 0) {
+            continue;
+        }
+
+        // Pass all completed reads to the decode threads.
+        io_uring_cqe* cqe = nullptr;
+        int result        = io_uring_wait_cqe(&m_ring, &cqe);
+        while(result == 0) {
+            std::unique_ptr<ChunkRead> read(static_cast<ChunkRead*>(io_uring_cqe_get_data(cqe)));
+            if(!read) {
+                // Completion of a no-op that replaced a failed submission.
+                io_uring_cqe_seen(&m_ring, cqe);
+                result = io_uring_peek_cqe(&m_ring, &cqe);
+                continue;
+            }
+            if(cqe->res < 0) {
+                read->error = std::make_exception_ptr(std::runtime_error("Failed to read file."));
+            } else {
+                read->data.resize(static_cast<size_t>(cqe->res));
+            }
+            io_uring_cqe_seen(&m_ring, cqe);
+            --inFlight;
+
+            m_decodeQueue.push(std::move(read));
+            result = io_uring_peek_cqe(&m_ring, &cqe);
+        }
+    }
+}
+
+#endif
+
+void ChunkLoader::Impl::runDecoder()
+{
+    std::unique_ptr<ChunkRead> read;
+    while(m_decodeQueue.pop(read)) {
+        Result result;
+        result.filename = read->region->filename;
+        result.index    = read->index;
+        result.error    = read->error;
+        if(!result.error) {
+            try {
+                CompressionType compression          = CompressionType::Uncompressed;
+                std::span<const unsigned char> data = chunkSectorData(read->data, compression);
+                result.chunk.setRootTag(decodeChunk(compression, data));
+            } catch(...) {
+                result.error = std::current_exception();
+            }
+        }
+        read.reset();
+
+        try {
+            m_callback(std::move(result));
+        } catch(...) {
+            std::lock_guard<std::mutex> lock(m_workMutex);
+            if(!m_callbackError) {
+                m_callbackError = std::current_exception();
+            }
+        }
+        finishWork(1);
+    }
+}
+
+void ChunkLoader::Impl::addWork(size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_workMutex);
+    m_pendingWork += count;
+}
+
+void ChunkLoader::Impl::finishWork(size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_workMutex);
+    m_pendingWork -= count;
+    if(m_pendingWork == 0) {
+        m_workDone.notify_all();
+    }
+}
+
+ChunkLoader::ChunkLoader(Callback callback, const Options& options)
+    : m_impl(std::make_unique<Impl>(std::move(callback), options))
+{ }
+
+ChunkLoader::ChunkLoader(Callback callback)
+    : ChunkLoader(std::move(callback), Options{})
+{ }
+
+ChunkLoader::~ChunkLoader()
+{
+    try {
+        m_impl->wait();
+    } catch(...) {
+        // Exceptions of the callback can not be reported anymore.
+    }
+}
+
+void ChunkLoader::load(const std::string& filename)
+{
+    std::vector<size_t> indices(Region::Chunks);
+    std::iota(indices.begin(), indices.end(), size_t{0});
+    load(filename, indices);
+}
+
+void ChunkLoader::load(const std::string& filename, const std::vector<size_t>& indices)
+{
+    for(size_t index : indices) {
+        if(index >= Region::Chunks) {
+            throw std::out_of_range("Index is out of range.");
+        }
+    }
+
+    RegionJob job;
+    job.filename = filename;
+    job.indices  = indices;
+    m_impl->load(std::move(job));
+}
+
+void ChunkLoader::wait()
+{
+    m_impl->wait();
+}
+
+ChunkLoader::Backend ChunkLoader::backend() const
+{
+    return m_impl->backend();
+}
+
+bool ChunkLoader::isIoUringSupported()
+{
+#if defined(CPPANVIL_HAS_IO_URING)
+    // The kernel may not provide io_uring or forbid it, e.g. in containers.
+    static const bool supported = [] {
+        io_uring ring{};
+        if(io_uring_queue_init(1, &ring, 0) != 0) {
+            return false;
+        }
+        io_uring_queue_exit(&ring);
+        return true;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // namespace anvil
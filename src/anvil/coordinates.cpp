@@ -22,4 +22,21 @@ Vec2 chunkWorld2ChunkRegion(Vec2 worldCoords)
     return regionCoords;
 }
 
+Vec2 chunkWorld2Region(Vec2 worldCoords)
+{
+    // Round towards negative infinity, chunk -1 is in region -1.
+    constexpr int32_t Axis = static_cast<int32_t>(Region::ChunksPerRegionAxis);
+
+    Vec2 regionCoords;
+    regionCoords.x = (worldCoords.x >= 0) ? worldCoords.x / Axis : (worldCoords.x + 1) / Axis - 1;
+    regionCoords.z = (worldCoords.z >= 0) ? worldCoords.z / Axis : (worldCoords.z + 1) / Axis - 1;
+    return regionCoords;
+}
+
+uint64_t regionKey(Vec2 regionCoord)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(regionCoord.x)) << 32)
+           | static_cast<uint64_t>(static_cast<uint32_t>(regionCoord.z));
+}
+
 } // namespace anvil
@@ -4,32 +4,83 @@
 #include "cpp-anvil/util/compression.hpp"
 
 // Internal headers
+#include "anvil/chunk_codec.hpp"
 #include "anvil/region_header.hpp"
+#include "anvil/sector_map.hpp"
+#include "nbt/tag_memory.hpp"
 #include "util/byte_swap.hpp"
+#include "util/memory_mapped_file.hpp"
+#include "util/parallel.hpp"
+#include "util/random_access_file.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <numeric>
 #include <regex>
+#include <string_view>
 
 namespace anvil {
 
+struct Region::ChunkPayload
+{
+    size_t index{0};
+    CompressionType compressionType{CompressionType::Uncompressed};
+    std::span<const unsigned char> data;
+
+    //! Owns the data if it was read from a stream or has been compressed.
+    std::vector<unsigned char> buffer;
+};
+
 Region::Region()
 {
     m_loadedChunks.fill(false);
     m_chunkCompression.fill(CompressionType::Uncompressed);
+    m_dirtyChunks.fill(false);
+    m_accessedChunks.fill(false);
+    m_treeHashes.fill(0);
+    m_chunkMemory.fill(0);
+    m_rawMemory.fill(0);
 }
 
 Region::~Region() = default;
 
-void Region::loadFromFile(const std::string& filename)
+void Region::resetChunks()
+{
+    m_regionHeader.reset();
+    m_mappedFile.reset();
+    m_filename.clear();
+
+    for(size_t index = 0; index < Chunks; ++index) {
+        m_chunks[index].clear();
+        m_rawChunks[index].clear();
+        m_rawChunks[index].shrink_to_fit();
+    }
+    m_loadedChunks.fill(false);
+    m_chunkCompression.fill(CompressionType::Uncompressed);
+    m_dirtyChunks.fill(false);
+    m_accessedChunks.fill(false);
+    m_chunkMemory.fill(0);
+    m_rawMemory.fill(0);
+    m_memoryUsage.store(0, std::memory_order_relaxed);
+    m_unmeasuredChunks.clear();
+    m_invalidChunks.clear();
+    m_compressedBytes.store(0, std::memory_order_relaxed);
+    m_uncompressedBytes.store(0, std::memory_order_relaxed);
+}
+
+void Region::loadFromFile(const std::string& filename, FileAccess access)
 {
-    loadPartiallyFromFile(filename);
+    loadPartiallyFromFile(filename, access);
 
-    loadAllChunks();
+    if(!m_lazyLoading) {
+        loadAllChunks();
+    }
 }
 
-void Region::loadPartiallyFromFile(const std::string& filename)
+void Region::loadPartiallyFromFile(const std::string& filename, FileAccess access)
 {
     // Check if region filename is valid and extract region coordinates
     int32_t x = 0;
@@ -38,23 +89,49 @@ void Region::loadPartiallyFromFile(const std::string& filename)
         throw std::runtime_error("Invalid region filename.");
     }
 
-    // Open filestream for reading
-    std::ifstream stream(filename, std::ios::binary);
-    if(!stream.is_open()) {
-        throw std::runtime_error("Failed to open region file.");
-    }
+    // Nothing of a previously loaded file must be written to the new one.
+    resetChunks();
 
-    // Check if the file is not empty and contains at least the header size
-    stream.seekg(0, std::ios::end);
-    std::streampos fileSize = stream.tellg();
-    stream.seekg(0, std::ios::beg);
-    if(fileSize < RegionHeader::HeaderSize) {
-        throw std::runtime_error("Region file is too small to contain a valid header.");
-    }
+    if(access == FileAccess::MemoryMapped) {
+        // Map the whole region file once, all chunks are read from the mapping afterwards.
+        auto mappedFile = std::make_unique<MemoryMappedFile>();
+        if(!mappedFile->open(filename)) {
+            throw std::runtime_error("Failed to map region file.");
+        }
+        if(mappedFile->size() < RegionHeader::HeaderSize) {
+            throw std::runtime_error("Region file is too small to contain a valid header.");
+        }
 
-    // Read region file header data
-    if(!readRegionHeader(stream)) {
-        throw std::runtime_error("Failed to read region header.");
+        // Read region file header data
+        m_regionHeader = std::make_unique<RegionHeader>();
+        if(!m_regionHeader->loadFromData(mappedFile->bytes(0, RegionHeader::HeaderSize))) {
+            throw std::runtime_error("Failed to read region header.");
+        }
+        m_invalidChunks = m_regionHeader->clearInvalid(mappedFile->size());
+
+        m_mappedFile = std::move(mappedFile);
+    } else {
+        // Open filestream for reading
+        std::ifstream stream(filename, std::ios::binary);
+        if(!stream.is_open()) {
+            throw std::runtime_error("Failed to open region file.");
+        }
+
+        // Check if the file is not empty and contains at least the header size
+        stream.seekg(0, std::ios::end);
+        std::streampos fileSize = stream.tellg();
+        stream.seekg(0, std::ios::beg);
+        if(fileSize < RegionHeader::HeaderSize) {
+            throw std::runtime_error("Region file is too small to contain a valid header.");
+        }
+
+        // Read region file header data
+        if(!readRegionHeader(stream)) {
+            throw std::runtime_error("Failed to read region header.");
+        }
+        m_invalidChunks = m_regionHeader->clearInvalid(static_cast<size_t>(fileSize));
+
+        m_mappedFile.reset();
     }
 
     // Store infos of the current region file
@@ -69,34 +146,193 @@ void Region::loadChunkAt(size_t index)
         throw std::out_of_range("Index is out of range.");
     }
 
-    // If the chunk is already loaded or the chunk is marked as empty, we are done here
-    if(isChunkLoaded(index) || !isChunkLoadable(index)) {
-        return;
+    materializeChunk(index);
+}
+
+void Region::loadAllChunks()
+{
+    loadAllChunks(1);
+}
+
+void Region::loadAllChunks(size_t threadCount)
+{
+    std::vector<size_t> indices(Chunks);
+    std::iota(indices.begin(), indices.end(), size_t{0});
+    loadChunks(indices, threadCount);
+}
+
+void Region::loadChunks(const std::vector<size_t>& indices, size_t threadCount)
+{
+    // Collect the chunks that have to be loaded, ordered by their location in the file. Chunks
+    // with raw chunk data in memory are not read from the file and go first.
+    auto fileOffset = [this](size_t index) -> size_t {
+        return m_rawChunks[index].empty() ? m_regionHeader->offset(index) : 0;
+    };
+    std::vector<std::pair<size_t, size_t>> pending;
+    pending.reserve(indices.size());
+    for(size_t index : indices) {
+        checkRange(index);
+        if(!isChunkLoaded(index) && isChunkLoadable(index)) {
+            pending.emplace_back(fileOffset(index), index);
+        }
     }
+    std::sort(pending.begin(), pending.end());
+    pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+    std::vector<size_t> ordered(pending.size());
+    std::transform(pending.begin(), pending.end(), ordered.begin(),
+                   [](const auto& entry) { return entry.second; });
+
+    // Read the compressed data of all chunks first. Reading stays sequential, chunks stored in
+    // consecutive sectors are read at once.
+    std::vector<ChunkPayload> payloads;
+    payloads.reserve(ordered.size());
+    std::ifstream stream;
+    for(size_t first = 0; first < ordered.size();) {
+        if(m_mappedFile || !m_rawChunks[ordered[first]].empty()) {
+            payloads.push_back(rawChunkPayload(ordered[first], stream));
+            ++first;
+            continue;
+        }
 
-    // Open filestream
-    std::ifstream stream(m_filename, std::ios::binary);
-    if(!stream.is_open()) {
-        throw std::runtime_error("Failed to open region file.");
+        size_t last       = first;
+        size_t runSectors = m_regionHeader->size(ordered[first]);
+        while(last + 1 < ordered.size()) {
+            const size_t current = ordered[last];
+            const size_t next    = ordered[last + 1];
+            if(m_regionHeader->offset(next)
+                   != m_regionHeader->offset(current) + m_regionHeader->size(current)
+               || runSectors + m_regionHeader->size(next) > MaxReadSectors) {
+                break;
+            }
+            runSectors += m_regionHeader->size(next);
+            ++last;
+        }
+
+        readChunkRun(stream, std::span<const size_t>(ordered).subspan(first, last - first + 1),
+                     payloads);
+        first = last + 1;
     }
 
-    readChunkData(stream, index);
+    // Every payload is decoded into its own chunk slot, so the threads never share any state. The
+    // size hints are computed before, the compression ratio and the memory usage are updated
+    // after decoding.
+    // Decoding moves the payloads, so their compressed sizes are kept before.
+    std::vector<size_t> sizeHints(payloads.size());
+    std::vector<size_t> compressedSizes(payloads.size());
+    std::vector<size_t> sizes(payloads.size());
+    std::vector<size_t> treeMemory(payloads.size());
+    for(size_t i = 0; i < payloads.size(); ++i) {
+        sizeHints[i]       = uncompressedSizeHint(payloads[i]);
+        compressedSizes[i] = payloads[i].data.size();
+    }
+    detail::parallelFor(payloads.size(), threadCount, [&](size_t i) {
+        const size_t index = payloads[i].index;
+        sizes[i]           = decodeChunkData(std::move(payloads[i]), sizeHints[i]);
+        treeMemory[i]      = estimateTagMemory(m_chunks[index].rootTag());
+    });
+    for(size_t i = 0; i < payloads.size(); ++i) {
+        learnCompressionRatio(payloads[i].compressionType, compressedSizes[i], sizes[i]);
+        accountChunkMemory(payloads[i].index, treeMemory[i]);
+    }
 }
 
-void Region::loadAllChunks()
+bool Region::unloadChunk(size_t index)
 {
-    // Open filestream
-    std::ifstream stream(m_filename, std::ios::binary);
-    if(!stream.is_open()) {
-        throw std::runtime_error("Failed to open region file.");
+    checkRange(index);
+
+    if(isChunkModified(index)) {
+        return false;
     }
 
-    // Iterate through all chunks and load if not already loaded or empty.
-    for(size_t chunkIndex = 0; chunkIndex < Chunks; ++chunkIndex) {
-        if(!isChunkLoaded(chunkIndex) && isChunkLoadable(chunkIndex)) {
-            readChunkData(stream, chunkIndex);
+    m_chunks[index].clear();
+    m_loadedChunks[index]   = false;
+    m_accessedChunks[index] = false;
+
+    // Raw chunk data that is not stored in the file yet must be kept.
+    if(!m_dirtyChunks[index]) {
+        m_rawChunks[index].clear();
+        m_rawChunks[index].shrink_to_fit();
+    }
+    accountChunkMemory(index, 0);
+    return true;
+}
+
+size_t Region::unloadAll()
+{
+    size_t count = 0;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(m_loadedChunks[index] && unloadChunk(index)) {
+            ++count;
         }
     }
+    return count;
+}
+
+void Region::forEachChunk(const ChunkVisitor& visitor, size_t threadCount)
+{
+    // Order the stored chunks like loadChunks() does, so that every batch is read sequentially.
+    std::vector<std::pair<size_t, size_t>> stored;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(isChunkLoaded(index) || isChunkLoadable(index)) {
+            const bool inFile = m_regionHeader && !m_regionHeader->empty(index);
+            stored.emplace_back(inFile ? m_regionHeader->offset(index) : 0, index);
+        }
+    }
+    std::sort(stored.begin(), stored.end());
+
+    // A batch covers up to MaxReadSectors sectors independent of the thread count, so that it is
+    // read with few coalesced reads. Loaded chunks are not read again, chunks that are not in the
+    // file count as one sector.
+    auto sectorsOf = [this](size_t index) -> size_t {
+        if(isChunkLoaded(index)) {
+            return 0;
+        }
+        const bool inFile = m_rawChunks[index].empty() && m_regionHeader
+                            && !m_regionHeader->empty(index);
+        return inFile ? m_regionHeader->size(index) : 1;
+    };
+    std::vector<size_t> batch;
+    std::vector<bool> wasLoaded;
+    for(size_t first = 0; first < stored.size();) {
+        batch.clear();
+        wasLoaded.clear();
+        size_t batchSectors = 0;
+        for(; first < stored.size(); ++first) {
+            const size_t index   = stored[first].second;
+            const size_t sectors = sectorsOf(index);
+            if(!batch.empty() && batchSectors + sectors > MaxReadSectors) {
+                break;
+            }
+            batchSectors += sectors;
+            batch.push_back(index);
+            wasLoaded.push_back(isChunkLoaded(index));
+        }
+
+        loadChunks(batch, threadCount);
+        for(size_t i = 0; i < batch.size(); ++i) {
+            const Chunk& chunk = m_chunks[batch[i]];
+            visitor(batch[i], chunk);
+            if(!wasLoaded[i]) {
+                unloadChunk(batch[i]);
+            }
+        }
+    }
+}
+
+size_t Region::loadedChunkCount() const
+{
+    return static_cast<size_t>(std::count(m_loadedChunks.begin(), m_loadedChunks.end(), true));
+}
+
+void Region::setLazyLoading(bool lazy)
+{
+    m_lazyLoading = lazy;
+}
+
+bool Region::isLazyLoading() const
+{
+    return m_lazyLoading;
 }
 
 bool Region::isChunkLoaded(size_t index) const
@@ -106,7 +342,195 @@ bool Region::isChunkLoaded(size_t index) const
 
 bool Region::isChunkLoadable(size_t index) const
 {
-    return m_regionHeader && !m_regionHeader->empty(index);
+    return !m_rawChunks[index].empty() || (m_regionHeader && !m_regionHeader->empty(index));
+}
+
+bool Region::isChunkDirty(size_t index) const
+{
+    return m_dirtyChunks[index] || hasTreeChanged(index);
+}
+
+void Region::markChunkDirty(size_t index)
+{
+    checkRange(index);
+
+    m_dirtyChunks[index] = true;
+
+    // The tree is measured again by the next memoryUsage(), not on every call.
+    if(std::find(m_unmeasuredChunks.begin(), m_unmeasuredChunks.end(), index)
+       == m_unmeasuredChunks.end()) {
+        m_unmeasuredChunks.push_back(index);
+    }
+}
+
+bool Region::commitChunk(size_t index)
+{
+    checkRange(index);
+
+    if(hasTreeChanged(index)) {
+        markChunkDirty(index);
+    }
+    m_accessedChunks[index] = false;
+    return m_dirtyChunks[index];
+}
+
+std::span<const unsigned char> Region::rawChunkData(size_t index) const
+{
+    checkRange(index);
+
+    if(isChunkModified(index) || !isChunkLoadable(index)) {
+        return {};
+    }
+
+    std::ifstream stream;
+    ChunkPayload payload      = rawChunkPayload(index, stream);
+    m_chunkCompression[index] = payload.compressionType;
+
+    // Data read from a stream is cached, moving the buffer keeps the span of the payload valid.
+    if(!payload.buffer.empty()) {
+        m_rawChunks[index] = std::move(payload.buffer);
+        accountChunkMemory(index, m_chunkMemory[index]);
+    }
+    return payload.data;
+}
+
+CompressionType Region::rawChunkCompression(size_t index) const
+{
+    if(rawChunkData(index).empty()) {
+        return CompressionType::Uncompressed;
+    }
+    return m_chunkCompression[index];
+}
+
+void Region::setRawChunkData(size_t index, std::span<const unsigned char> data,
+                             CompressionType compression)
+{
+    checkRange(index);
+
+    if(data.empty()) {
+        throw std::runtime_error("Raw chunk data is empty.");
+    }
+
+    // Copy first, the data may reference the raw data of this region.
+    std::vector<unsigned char> rawData(data.begin(), data.end());
+    m_rawChunks[index] = std::move(rawData);
+
+    m_chunks[index].clear();
+    m_chunkCompression[index] = compression;
+    m_loadedChunks[index]     = false;
+    m_dirtyChunks[index]      = true;
+    m_accessedChunks[index]   = false;
+    accountChunkMemory(index, 0);
+}
+
+CompressionType Region::chunkCompression(size_t index) const
+{
+    checkRange(index);
+    return m_chunkCompression[index];
+}
+
+void Region::setChunkCompression(size_t index, CompressionType compression)
+{
+    checkRange(index);
+
+    if((compression != CompressionType::Gzip && compression != CompressionType::Zlib
+        && compression != CompressionType::Uncompressed && compression != CompressionType::Lz4)
+       || (compression == CompressionType::Lz4 && !isLz4Supported())) {
+        throw std::runtime_error("Unsupported compression type.");
+    }
+    if(compression == m_chunkCompression[index]) {
+        return;
+    }
+
+    // The chunk has to be compressed again, so its raw data can not be written back.
+    if(isChunkLoaded(index) || isChunkLoadable(index)) {
+        materializeChunk(index);
+        m_dirtyChunks[index] = true;
+    }
+    m_chunkCompression[index] = compression;
+}
+
+Region::CompactionResult Region::compact(ChunkOrder order)
+{
+    if(m_filename.empty()) {
+        throw std::runtime_error("Region has no filename to compact.");
+    }
+
+    const std::string compactedFilename = m_filename + ".compact";
+    CompactionResult result;
+    try {
+        result = compactFile(m_filename, compactedFilename, order);
+    } catch(...) {
+        // Do not leave a partially written file behind.
+        std::error_code ec;
+        std::filesystem::remove(compactedFilename, ec);
+        throw;
+    }
+
+    // Replace the region file and read the new header. The raw chunk data is unchanged.
+    const bool remap = m_mappedFile != nullptr;
+    if(remap) {
+        m_mappedFile->close();
+    }
+    std::filesystem::rename(compactedFilename, m_filename);
+
+    if(remap) {
+        if(!m_mappedFile->open(m_filename)
+           || !m_regionHeader->loadFromData(m_mappedFile->bytes(0, RegionHeader::HeaderSize))) {
+            throw std::runtime_error("Failed to map region file.");
+        }
+    } else {
+        std::ifstream stream(m_filename, std::ios::binary);
+        if(!stream.is_open() || !readRegionHeader(stream)) {
+            throw std::runtime_error("Failed to read region header.");
+        }
+    }
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size(m_filename, ec);
+    if(ec || !m_regionHeader->isValid(static_cast<size_t>(fileSize))) {
+        throw std::runtime_error("Region header contains invalid chunk locations.");
+    }
+    m_invalidChunks.clear();
+
+    return result;
+}
+
+bool Region::hasUnsavedChanges() const
+{
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(isChunkModified(index) || (m_dirtyChunks[index] && !m_rawChunks[index].empty())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t Region::memoryUsage() const
+{
+    for(const size_t index : m_unmeasuredChunks) {
+        if(m_loadedChunks[index] || !m_chunks[index].empty()) {
+            accountChunkMemory(index, estimateTagMemory(m_chunks[index].rootTag()));
+        }
+    }
+    m_unmeasuredChunks.clear();
+
+    // Chunks returned by the non-const chunkAt() may have changed at any time.
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(m_accessedChunks[index] && !m_chunks[index].empty()) {
+            accountChunkMemory(index, estimateTagMemory(m_chunks[index].rootTag()));
+        }
+    }
+    return sizeof(Region) + m_memoryUsage.load(std::memory_order_relaxed);
+}
+
+const std::string& Region::filename() const
+{
+    return m_filename;
+}
+
+Region::FileAccess Region::fileAccess() const
+{
+    return m_mappedFile ? FileAccess::MemoryMapped : FileAccess::Stream;
 }
 
 bool Region::saveToFile()
@@ -116,52 +540,56 @@ bool Region::saveToFile()
 
 bool Region::saveToFile(const std::string& filename)
 {
+    return saveToFile(filename, 1);
+}
+
+bool Region::saveToFile(const std::string& filename, size_t threadCount)
+{
+    // Unmodified chunks are written with their original compressed data. This is read
+    // sequentially, chunks that are not loaded are read from the source file.
+    std::vector<ChunkPayload> payloads(Chunks);
+    std::vector<bool> modified(Chunks, false);
+    std::ifstream sourceStream;
+    for(size_t index = 0; index < Chunks; ++index) {
+        modified[index] = isChunkModified(index);
+        if(!modified[index] && isChunkLoadable(index)) {
+            payloads[index] = rawChunkPayload(index, sourceStream);
+        }
+    }
+    sourceStream.close();
+
+    // Serialize and compress all other chunks. This is independent for every chunk and can be
+    // done in parallel, the sectors are assigned afterwards in index order.
+    detail::parallelFor(Chunks, threadCount, [this, &payloads](size_t index) {
+        ChunkPayload& payload = payloads[index];
+        if(payload.data.empty() && !m_chunks[index].empty()) {
+            payload.index           = index;
+            payload.compressionType = m_chunkCompression[index];
+            payload.buffer          = compressChunkData(index);
+            payload.data            = payload.buffer;
+        }
+    });
+
     std::vector<unsigned char> regionData(RegionHeader::HeaderSize, 0);
     size_t storageDataOffset = RegionHeader::HeaderSize;
     RegionHeader regionHeader;
 
     for(size_t index = 0; index < Chunks; ++index) {
-        if(m_chunks[index].empty()) {
+        const ChunkPayload& payload = payloads[index];
+        if(payload.data.empty()) {
             regionHeader.setChunkData(index, 0, 0, 0);
         } else {
-            CompressionType compression = m_chunkCompression[index];
-            CompoundTag* rootTag        = m_chunks[index].rootTag();
-
-            // Compress the serialized chunk data.
-            std::vector<unsigned char> serializedData = writeData(rootTag);
-            std::vector<unsigned char> chunkData;
-            if(compression == CompressionType::Zlib) {
-                // This is the usual case
-                if(!deflate_zlib(serializedData, chunkData)) {
-                    throw std::runtime_error("Failed to compress chunk data (zlib).");
-                }
-            } else if(compression == CompressionType::Gzip) {
-                // Regions are rarely compressed with gzip. But in case it should, we can do!
-                if(!deflate_gzip(serializedData, chunkData)) {
-                    throw std::runtime_error("Failed to compress chunk data (zlib).");
-                }
-            } else if(compression == CompressionType::Uncompressed) {
-                // This is super rare condition and should usually not occur.
-                // But we can also handle this.
-                chunkData = std::move(serializedData);
-            }
-
             // calculate some sizes.
-            size_t length        = 1u + chunkData.size();
-            size_t payload       = 4u + length;
-            size_t sectorPadding = (((payload % SectorSize) > 0) ? 1 : 0);
-            size_t sectors       = payload / SectorSize + sectorPadding;
-            size_t storageSize   = sectors * SectorSize;
+            size_t sectors     = sectorsForChunk(payload.data.size());
+            size_t storageSize = sectors * SectorSize;
 
             // Set chunk infos in region header.
             regionHeader.setChunkData(index, storageDataOffset / SectorSize, sectors, 0);
 
             // Write the chunk to the region data.
             regionData.resize(regionData.size() + storageSize, 0);
-            length = detail::swapEndian(length);
-            std::memcpy(&regionData[storageDataOffset], &length, 4u);
-            std::memcpy(&regionData[storageDataOffset + 4], &compression, 1u);
-            std::memcpy(&regionData[storageDataOffset + 5], chunkData.data(), chunkData.size());
+            writeChunkSectors(&regionData[storageDataOffset], payload.compressionType,
+                              payload.data);
 
             // Increase the data index to beginning of next chunk.
             storageDataOffset += storageSize;
@@ -172,6 +600,16 @@ bool Region::saveToFile(const std::string& filename)
     // we can now also write the region header data.
     std::memcpy(&regionData[0], regionHeader.headerData(), regionHeader.headerSize());
 
+    // When the source file is overwritten, a mapping of it must be released first. Otherwise the
+    // mapped pages would be invalidated by truncating the file.
+    std::error_code ec;
+    const bool overwritesSource =
+        !m_filename.empty() && std::filesystem::equivalent(filename, m_filename, ec);
+    const bool remap = overwritesSource && m_mappedFile;
+    if(remap) {
+        m_mappedFile->close();
+    }
+
     std::ofstream stream(filename, std::ios::binary);
     if(!stream.is_open()) {
         throw std::runtime_error("Failed to open file.");
@@ -179,6 +617,159 @@ bool Region::saveToFile(const std::string& filename)
     stream.write(reinterpret_cast<char*>(regionData.data()), regionData.size());
     stream.close();
 
+    // Keep the region in sync with the file it was loaded from.
+    if(overwritesSource) {
+        if(m_regionHeader) {
+            *m_regionHeader = regionHeader;
+        }
+        m_dirtyChunks.fill(false);
+        m_invalidChunks.clear();
+        for(size_t index = 0; index < Chunks; ++index) {
+            payloads[index].index = index;
+            updateRawChunkData(payloads[index]);
+            if(modified[index]) {
+                rememberTree(index);
+            }
+        }
+        if(remap && !m_mappedFile->open(m_filename)) {
+            throw std::runtime_error("Failed to map region file.");
+        }
+    }
+
+    return true;
+}
+
+bool Region::saveChanges()
+{
+    if(m_filename.empty()) {
+        throw std::runtime_error("Region has no filename to save to.");
+    }
+
+    std::error_code ec;
+    if(!m_regionHeader || !std::filesystem::exists(m_filename, ec)) {
+        return saveToFile(m_filename);
+    }
+
+    // Chunks which were only accessed but never loaded keep their data in the file. Chunks with
+    // raw chunk data set by setRawChunkData() are written unchanged.
+    std::vector<bool> modified(Chunks, false);
+    std::vector<bool> changed(Chunks, false);
+    for(size_t index = 0; index < Chunks; ++index) {
+        modified[index] = isChunkModified(index);
+        changed[index]  = modified[index] || (m_dirtyChunks[index] && !m_rawChunks[index].empty());
+    }
+    // Invalid entries are cleared in the file, so that no other chunk is found at their location.
+    for(const size_t index : m_invalidChunks) {
+        changed[index] = true;
+    }
+    if(std::find(changed.begin(), changed.end(), true) == changed.end()) {
+        return true;
+    }
+
+    // Compress the modified chunks.
+    std::vector<ChunkPayload> payloads(Chunks);
+    std::vector<size_t> sectors(Chunks, 0);
+    std::ifstream sourceStream;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(!changed[index]) {
+            continue;
+        }
+        ChunkPayload& payload = payloads[index];
+        if(!modified[index] && isChunkLoadable(index)) {
+            payload = rawChunkPayload(index, sourceStream);
+        } else if(!m_chunks[index].empty()) {
+            payload.index           = index;
+            payload.compressionType = m_chunkCompression[index];
+            payload.buffer          = compressChunkData(index);
+            payload.data            = payload.buffer;
+        }
+        if(!payload.data.empty()) {
+            sectors[index] = sectorsForChunk(payload.data.size());
+        }
+    }
+
+    // The sectors of modified chunks are free, all others stay untouched. Chunks that still fit
+    // into their sectors are kept in place, the others are moved to free or appended sectors.
+    const size_t fileSize = std::filesystem::file_size(m_filename);
+    SectorMap sectorMap   = SectorMap::fromHeader(*m_regionHeader, fileSize, changed);
+    std::vector<size_t> offsets(Chunks, 0);
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(sectors[index] > 0 && !m_regionHeader->empty(index)
+           && sectors[index] <= m_regionHeader->size(index)) {
+            offsets[index] = m_regionHeader->offset(index);
+            sectorMap.markUsed(offsets[index], sectors[index]);
+        }
+    }
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(sectors[index] > 0 && offsets[index] == 0) {
+            offsets[index] = sectorMap.allocate(sectors[index]);
+        }
+    }
+
+    // Release the mapping, it is created again for the new file size afterwards.
+    const bool remap = m_mappedFile != nullptr;
+    if(remap) {
+        m_mappedFile->close();
+    }
+
+    std::fstream stream(m_filename, std::ios::binary | std::ios::in | std::ios::out);
+    if(!stream.is_open()) {
+        throw std::runtime_error("Failed to open file.");
+    }
+
+    // Write the chunk data first and patch the header afterwards.
+    const uint32_t timestamp = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count());
+    std::vector<unsigned char> sectorData;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(sectors[index] == 0) {
+            continue;
+        }
+        sectorData.assign(sectors[index] * SectorSize, 0);
+        writeChunkSectors(sectorData.data(), payloads[index].compressionType, payloads[index].data);
+        stream.seekp(offsets[index] * SectorSize);
+        stream.write(reinterpret_cast<const char*>(sectorData.data()), sectorData.size());
+    }
+
+    const unsigned char* headerData = m_regionHeader->headerData();
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(!changed[index]) {
+            continue;
+        }
+        if(sectors[index] > 0) {
+            m_regionHeader->setChunkData(index, offsets[index], sectors[index], timestamp);
+        } else {
+            m_regionHeader->setChunkData(index, 0, 0, 0);
+        }
+
+        const size_t locationOffset  = index * sizeof(uint32_t);
+        const size_t timestampOffset = (Chunks + index) * sizeof(uint32_t);
+        stream.seekp(locationOffset);
+        stream.write(reinterpret_cast<const char*>(headerData + locationOffset), sizeof(uint32_t));
+        stream.seekp(timestampOffset);
+        stream.write(reinterpret_cast<const char*>(headerData + timestampOffset), sizeof(uint32_t));
+
+        payloads[index].index = index;
+        updateRawChunkData(payloads[index]);
+        m_dirtyChunks[index] = false;
+        if(modified[index]) {
+            rememberTree(index);
+        }
+    }
+
+    stream.close();
+    if(!stream) {
+        throw std::runtime_error("Failed to write region file.");
+    }
+
+    m_invalidChunks.clear();
+
+    if(remap && !m_mappedFile->open(m_filename)) {
+        throw std::runtime_error("Failed to map region file.");
+    }
+
     return true;
 }
 
@@ -204,6 +795,15 @@ Chunk& Region::chunkAt(size_t index)
 {
     checkRange(index);
 
+    if(m_lazyLoading) {
+        materializeChunk(index);
+    }
+
+    // The chunk may be changed through the reference, saves compare it with its current tree.
+    if(!m_accessedChunks[index]) {
+        rememberTree(index);
+        m_accessedChunks[index] = true;
+    }
     return m_chunks[index];
 }
 
@@ -211,20 +811,23 @@ Chunk& Region::chunkAt(int32_t x, int32_t z)
 {
     checkRange(x, z);
 
-    return m_chunks[toIndex(x, z)];
+    return chunkAt(toIndex(x, z));
 }
 
 Chunk& Region::chunkAt(const Vec2& coord)
 {
     checkRange(coord.x, coord.z);
 
-    return m_chunks[toIndex(coord.x, coord.z)];
+    return chunkAt(toIndex(coord.x, coord.z));
 }
 
 const Chunk& Region::chunkAt(size_t index) const
 {
     checkRange(index);
 
+    if(m_lazyLoading) {
+        materializeChunk(index);
+    }
     return m_chunks[index];
 }
 
@@ -232,14 +835,14 @@ const Chunk& Region::chunkAt(int32_t x, int32_t z) const
 {
     checkRange(x, z);
 
-    return m_chunks[toIndex(x, z)];
+    return chunkAt(toIndex(x, z));
 }
 
 const Chunk& Region::chunkAt(const Vec2& coord) const
 {
     checkRange(coord.x, coord.z);
 
-    return m_chunks[toIndex(coord.x, coord.z)];
+    return chunkAt(toIndex(coord.x, coord.z));
 }
 
 void Region::checkRange(int32_t x, int32_t z) const
@@ -256,7 +859,96 @@ void Region::checkRange(size_t index) const
     }
 }
 
-void Region::readChunkData(std::ifstream& filestream, const size_t index)
+bool Region::isChunkModified(size_t index) const
+{
+    // Chunks which were only accessed but never loaded still match their raw chunk data.
+    return (m_dirtyChunks[index] && (m_loadedChunks[index] || !m_chunks[index].empty()))
+           || hasTreeChanged(index);
+}
+
+bool Region::hasTreeChanged(size_t index) const
+{
+    return m_accessedChunks[index] && treeHash(index) != m_treeHashes[index];
+}
+
+void Region::rememberTree(size_t index) const
+{
+    m_treeHashes[index] = treeHash(index);
+}
+
+size_t Region::treeHash(size_t index) const
+{
+    if(m_chunks[index].empty()) {
+        return 0;
+    }
+
+    // Serializing is much cheaper than compressing, and catches every change of the tree.
+    const std::vector<unsigned char> data = writeData(m_chunks[index].rootTag());
+    return std::hash<std::string_view>{}(
+        std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+void Region::openFileStream(std::ifstream& filestream) const
+{
+    if(!filestream.is_open()) {
+        filestream.open(m_filename, std::ios::binary);
+        if(!filestream.is_open()) {
+            throw std::runtime_error("Failed to open region file.");
+        }
+    }
+}
+
+Region::ChunkPayload Region::rawChunkPayload(const size_t index, std::ifstream& filestream) const
+{
+    if(!m_rawChunks[index].empty()) {
+        ChunkPayload payload;
+        payload.index           = index;
+        payload.compressionType = m_chunkCompression[index];
+        payload.data            = m_rawChunks[index];
+        return payload;
+    }
+
+    if(m_mappedFile) {
+        return readChunkPayload(index);
+    }
+
+    openFileStream(filestream);
+    return readChunkPayload(filestream, index);
+}
+
+void Region::readChunkRun(std::ifstream& filestream, std::span<const size_t> indices,
+                          std::vector<ChunkPayload>& payloads) const
+{
+    openFileStream(filestream);
+
+    // Read all sectors of the run at once. The last sector may be truncated at the end of file.
+    const size_t runOffset = m_regionHeader->byteOffset(indices.front());
+    const size_t runSize   = m_regionHeader->byteOffset(indices.back())
+                         + m_regionHeader->byteSize(indices.back()) - runOffset;
+    std::vector<unsigned char> runData(runSize);
+    filestream.seekg(runOffset, std::ios::beg);
+    filestream.read(reinterpret_cast<char*>(runData.data()), runSize);
+    runData.resize(static_cast<size_t>(filestream.gcount()));
+    filestream.clear();
+
+    for(size_t index : indices) {
+        const size_t offset = m_regionHeader->byteOffset(index) - runOffset;
+        if(offset >= runData.size()) {
+            throw std::runtime_error("Failed to read chunk data.");
+        }
+
+        ChunkPayload payload;
+        payload.index = index;
+        std::span<const unsigned char> data =
+            chunkSectorData(std::span<const unsigned char>(runData).subspan(offset),
+                            payload.compressionType);
+        payload.buffer.assign(data.begin(), data.end());
+        payload.data = payload.buffer;
+        payloads.push_back(std::move(payload));
+    }
+}
+
+Region::ChunkPayload Region::readChunkPayload(std::ifstream& filestream, const size_t index) const
 {
     // Seek to beginning of chunk data in the filestream
     size_t offset = m_regionHeader->byteOffset(index);
@@ -268,32 +960,197 @@ void Region::readChunkData(std::ifstream& filestream, const size_t index)
     dataSize                        = detail::swapEndian(dataSize);
     CompressionType compressionType = CompressionType::Uncompressed;
     filestream.read(reinterpret_cast<char*>(&compressionType), sizeof(char));
+    if(!filestream || dataSize == 0) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
 
     // Read the chunk data
-    std::vector<unsigned char> compressedChunkData(dataSize - 1, 0);
-    filestream.read(reinterpret_cast<char*>(&compressedChunkData[0]), dataSize - 1);
+    ChunkPayload payload;
+    payload.index           = index;
+    payload.compressionType = compressionType;
+    payload.buffer.resize(dataSize - 1);
+    filestream.read(reinterpret_cast<char*>(payload.buffer.data()), dataSize - 1);
+    if(!filestream) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
+    payload.data = payload.buffer;
 
-    std::vector<unsigned char> chunkData;
-    switch(compressionType) {
-        case CompressionType::Gzip:
-            if(!inflate_gzip(compressedChunkData, chunkData)) {
-                throw std::runtime_error("Failed to uncompress chunk data (gzip).");
-            }
-            break;
-        case CompressionType::Zlib:
-            if(!inflate_zlib(compressedChunkData, chunkData)) {
-                throw std::runtime_error("Failed to uncompress chunk data (zlib).");
-            }
-            break;
-        case CompressionType::Uncompressed:
-            break;
-        default:
-            throw std::runtime_error("Unknown compression type.");
+    return payload;
+}
+
+Region::ChunkPayload Region::readChunkPayload(const size_t index) const
+{
+    // Locate the chunk data in the mapped file
+    size_t offset                         = m_regionHeader->byteOffset(index);
+    std::span<const unsigned char> header = m_mappedFile->bytes(offset, 5u);
+    if(header.empty()) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
+
+    // Get size of binary data and compression type
+    uint32_t dataSize = 0;
+    std::memcpy(&dataSize, header.data(), sizeof(uint32_t));
+    dataSize = detail::swapEndian(dataSize);
+    if(dataSize == 0) {
+        throw std::runtime_error("Failed to read chunk data.");
     }
 
-    chunkAt(index).setRootTag(readData(chunkData));
-    m_chunkCompression[index] = compressionType;
+    // The payload references the mapped pages, it is inflated from there without a copy.
+    ChunkPayload payload;
+    payload.index           = index;
+    payload.compressionType = static_cast<CompressionType>(header[4]);
+    payload.data            = m_mappedFile->bytes(offset + 5u, dataSize - 1);
+    if(payload.data.size() != dataSize - 1) {
+        throw std::runtime_error("Failed to read chunk data.");
+    }
+
+    return payload;
+}
+
+void Region::materializeChunk(const size_t index) const
+{
+    // If the chunk is already loaded or the chunk is marked as empty, we are done here
+    if(isChunkLoaded(index) || !isChunkLoadable(index)) {
+        return;
+    }
+
+    std::ifstream stream;
+    ChunkPayload payload              = rawChunkPayload(index, stream);
+    const size_t sizeHint             = uncompressedSizeHint(payload);
+    const size_t compressedSize       = payload.data.size();
+    const CompressionType compression = payload.compressionType;
+    const size_t size                 = decodeChunkData(std::move(payload), sizeHint);
+    learnCompressionRatio(compression, compressedSize, size);
+    accountChunkMemory(index, estimateTagMemory(m_chunks[index].rootTag()));
+}
+
+size_t Region::decodeChunkData(ChunkPayload&& payload, size_t sizeHint) const
+{
+    const size_t index = payload.index;
+    size_t size        = 0;
+    m_chunks[index].setRootTag(
+        decodeChunk(payload.compressionType, payload.data, sizeHint, &size));
+    m_chunkCompression[index] = payload.compressionType;
     m_loadedChunks[index]     = true;
+    if(m_accessedChunks[index]) {
+        // Loading is no change of a chunk that has been accessed before.
+        rememberTree(index);
+    }
+
+    if(!payload.buffer.empty()) {
+        // Read from a stream, keep the data to write it back unchanged.
+        m_rawChunks[index]   = std::move(payload.buffer);
+        m_dirtyChunks[index] = false;
+    } else if(m_rawChunks[index].empty()) {
+        // Referenced in the memory mapped file.
+        m_dirtyChunks[index] = false;
+    }
+    // Otherwise the data was set by setRawChunkData() and is not stored in the file yet.
+    return size;
+}
+
+size_t Region::uncompressedSizeHint(const ChunkPayload& payload) const
+{
+    const size_t compressedBytes   = m_compressedBytes.load(std::memory_order_relaxed);
+    const size_t uncompressedBytes = m_uncompressedBytes.load(std::memory_order_relaxed);
+    if(compressedBytes == 0 || payload.compressionType == CompressionType::Uncompressed) {
+        return 0;
+    }
+
+    // Chunks of a region compress similarly. Some slack avoids doubling the buffer for chunks
+    // that compress slightly better than the average.
+    const double ratio = static_cast<double>(uncompressedBytes) / compressedBytes;
+    return static_cast<size_t>(static_cast<double>(payload.data.size()) * ratio * 1.125) + 64;
+}
+
+void Region::learnCompressionRatio(CompressionType compression, size_t compressedSize,
+                                   size_t uncompressedSize) const
+{
+    // Const lazy access decodes chunks as well, the sizes are only a hint and need no ordering.
+    if(compression != CompressionType::Uncompressed) {
+        m_compressedBytes.fetch_add(compressedSize, std::memory_order_relaxed);
+        m_uncompressedBytes.fetch_add(uncompressedSize, std::memory_order_relaxed);
+    }
+}
+
+void Region::updateRawChunkData(ChunkPayload& payload)
+{
+    const size_t index = payload.index;
+    if(payload.data.empty() || m_mappedFile || !m_loadedChunks[index]) {
+        m_rawChunks[index].clear();
+        m_rawChunks[index].shrink_to_fit();
+    } else if(!payload.buffer.empty()) {
+        // Data referencing the raw chunk data does not own a buffer and is kept as it is.
+        m_rawChunks[index]        = std::move(payload.buffer);
+        m_chunkCompression[index] = payload.compressionType;
+    } else {
+        m_chunkCompression[index] = payload.compressionType;
+    }
+    accountChunkMemory(index, m_chunkMemory[index]);
+}
+
+void Region::accountChunkMemory(size_t index, size_t treeMemory) const
+{
+    // Const access of different chunks accounts them concurrently, only the total is shared.
+    const size_t rawMemory = m_rawChunks[index].capacity();
+    m_memoryUsage.fetch_add(treeMemory + rawMemory, std::memory_order_relaxed);
+    m_memoryUsage.fetch_sub(m_chunkMemory[index] + m_rawMemory[index], std::memory_order_relaxed);
+    m_chunkMemory[index] = treeMemory;
+    m_rawMemory[index]   = rawMemory;
+}
+
+void Region::writeChunkSectors(unsigned char* target, CompressionType compression,
+                               std::span<const unsigned char> chunkData)
+{
+    uint32_t length = detail::swapEndian(static_cast<uint32_t>(1u + chunkData.size()));
+    std::memcpy(target, &length, 4u);
+    std::memcpy(target + 4, &compression, 1u);
+    std::memcpy(target + 5, chunkData.data(), chunkData.size());
+}
+
+size_t Region::sectorsForChunk(size_t dataSize)
+{
+    // 4 bytes length, 1 byte compression type and the data itself
+    size_t payload = 5u + dataSize;
+    size_t sectors = payload / SectorSize + (((payload % SectorSize) > 0) ? 1 : 0);
+    if(sectors > 0xFF) {
+        throw std::runtime_error("Chunk data exceeds the maximum chunk size.");
+    }
+    return sectors;
+}
+
+std::vector<unsigned char> Region::compressChunkData(const size_t index) const
+{
+    CompressionType compression = m_chunkCompression[index];
+    const CompoundTag* rootTag  = m_chunks[index].rootTag();
+
+    // Compress the serialized chunk data.
+    std::vector<unsigned char> serializedData = writeData(rootTag);
+    std::vector<unsigned char> chunkData;
+    Deflater& deflater = Deflater::threadLocal();
+    deflater.setCompressionLevel(DefaultCompression);
+    if(compression == CompressionType::Zlib) {
+        // This is the usual case
+        if(!deflater.deflate(compression, serializedData, chunkData)) {
+            throw std::runtime_error("Failed to compress chunk data (zlib).");
+        }
+    } else if(compression == CompressionType::Gzip) {
+        // Regions are rarely compressed with gzip. But in case it should, we can do!
+        if(!deflater.deflate(compression, serializedData, chunkData)) {
+            throw std::runtime_error("Failed to compress chunk data (gzip).");
+        }
+    } else if(compression == CompressionType::Uncompressed) {
+        // This is super rare condition and should usually not occur.
+        // But we can also handle this.
+        chunkData = std::move(serializedData);
+    } else if(compression == CompressionType::Lz4) {
+        if(!deflater.deflate(compression, serializedData, chunkData)) {
+            throw std::runtime_error("Failed to compress chunk data (lz4).");
+        }
+    } else {
+        throw std::runtime_error("Unsupported compression type.");
+    }
+    return chunkData;
 }
 
 bool Region::readRegionHeader(std::ifstream& filestream)
@@ -302,6 +1159,94 @@ bool Region::readRegionHeader(std::ifstream& filestream)
     return m_regionHeader->loadFromStream(filestream);
 }
 
+Region::CompactionResult Region::compactFile(const std::string& inputFilename,
+                                             const std::string& outputFilename, ChunkOrder order)
+{
+    std::error_code ec;
+    if(std::filesystem::equivalent(inputFilename, outputFilename, ec)) {
+        throw std::runtime_error("Compacted region file must differ from the input file.");
+    }
+
+    RandomAccessFile input;
+    if(!input.open(inputFilename)) {
+        throw std::runtime_error("Failed to open region file.");
+    }
+
+    std::vector<unsigned char> headerData(RegionHeader::HeaderSize);
+    RegionHeader header;
+    if(input.readAt(0, headerData.data(), headerData.size()) != headerData.size()
+       || !header.loadFromData(headerData)) {
+        throw std::runtime_error("Failed to read region header.");
+    }
+    // Chunks with invalid locations are dropped like in loadPartiallyFromFile().
+    header.clearInvalid(input.size());
+
+    // Collect the stored chunks in the requested order.
+    std::vector<size_t> indices;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(!header.empty(index)) {
+            indices.push_back(index);
+        }
+    }
+    if(order == ChunkOrder::Morton) {
+        auto mortonCode = [](size_t index) {
+            const Vec2 coord = fromIndex(index);
+            size_t code      = 0;
+            for(size_t bit = 0; bit < 5; ++bit) {
+                code |= ((static_cast<size_t>(coord.x) >> bit) & 1u) << (2 * bit);
+                code |= ((static_cast<size_t>(coord.z) >> bit) & 1u) << (2 * bit + 1);
+            }
+            return code;
+        };
+        std::sort(indices.begin(), indices.end(), [&mortonCode](size_t lhs, size_t rhs) {
+            return mortonCode(lhs) < mortonCode(rhs);
+        });
+    }
+
+    std::ofstream output(outputFilename, std::ios::binary);
+    if(!output.is_open()) {
+        throw std::runtime_error("Failed to open file.");
+    }
+
+    // The header is written last, when all chunk locations are known.
+    std::vector<unsigned char> sectorData(RegionHeader::HeaderSize, 0);
+    output.write(reinterpret_cast<const char*>(sectorData.data()), sectorData.size());
+
+    RegionHeader compactedHeader;
+    size_t sectorOffset = RegionHeader::HeaderSize / SectorSize;
+    std::vector<unsigned char> chunkSectors;
+    for(size_t index : indices) {
+        // The last sector may be truncated at the end of the file.
+        const size_t byteOffset = header.byteOffset(index);
+        chunkSectors.resize(std::min(header.byteSize(index), input.size() - byteOffset));
+        chunkSectors.resize(input.readAt(byteOffset, chunkSectors.data(), chunkSectors.size()));
+
+        CompressionType compression          = CompressionType::Uncompressed;
+        std::span<const unsigned char> data = chunkSectorData(chunkSectors, compression);
+
+        const size_t sectors = sectorsForChunk(data.size());
+        sectorData.assign(sectors * SectorSize, 0);
+        writeChunkSectors(sectorData.data(), compression, data);
+        output.write(reinterpret_cast<const char*>(sectorData.data()), sectorData.size());
+
+        compactedHeader.setChunkData(index, sectorOffset, sectors, header.timestamp(index));
+        sectorOffset += sectors;
+    }
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(compactedHeader.headerData()),
+                 compactedHeader.headerSize());
+    output.close();
+    if(!output) {
+        throw std::runtime_error("Failed to write region file.");
+    }
+
+    CompactionResult result;
+    result.originalSize  = input.size();
+    result.compactedSize = sectorOffset * SectorSize;
+    return result;
+}
+
 bool Region::validateRegionFilename(const std::string& filename)
 {
     int32_t x = 0;
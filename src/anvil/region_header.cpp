@@ -2,6 +2,8 @@
 #include "anvil/region_header.hpp"
 #include "util/byte_swap.hpp"
 
+#include <cstring>
+
 namespace anvil {
 
 bool RegionHeader::loadFromStream(std::ifstream& filestream)
@@ -10,6 +12,15 @@ bool RegionHeader::loadFromStream(std::ifstream& filestream)
     return filestream.gcount() == RegionHeader::HeaderSize;
 }
 
+bool RegionHeader::loadFromData(std::span<const unsigned char> data)
+{
+    if(data.size() < RegionHeader::HeaderSize) {
+        return false;
+    }
+    std::memcpy(m_data.data(), data.data(), RegionHeader::HeaderSize);
+    return true;
+}
+
 const std::array<unsigned char, RegionHeader::HeaderSize>& RegionHeader::data() const
 {
     return m_data;
@@ -65,6 +76,38 @@ uint32_t RegionHeader::timestamp(const size_t index) const
     return detail::swapEndian(dataAsInt[Chunks + index]);
 }
 
+bool RegionHeader::isValid(const size_t fileSize) const
+{
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(!isValid(index, fileSize)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RegionHeader::isValid(const size_t index, const size_t fileSize) const
+{
+    // The chunk must be located behind the header and its length and compression type must be
+    // within the file.
+    constexpr size_t HeaderSectors = HeaderSize / SectorSize;
+    return empty(index)
+           || (offset(index) >= HeaderSectors && size(index) > 0
+               && byteOffset(index) + 5u <= fileSize);
+}
+
+std::vector<size_t> RegionHeader::clearInvalid(const size_t fileSize)
+{
+    std::vector<size_t> cleared;
+    for(size_t index = 0; index < Chunks; ++index) {
+        if(!isValid(index, fileSize)) {
+            setChunkData(index, 0, 0, 0);
+            cleared.push_back(index);
+        }
+    }
+    return cleared;
+}
+
 void RegionHeader::setChunkData(const size_t index, const size_t offset, const size_t size,
                                 const uint32_t timestamp)
 {
@@ -4,6 +4,8 @@
 #include <array>
 #include <cstdint>
 #include <fstream>
+#include <span>
+#include <vector>
 
 namespace anvil {
 
@@ -16,6 +18,7 @@ public:
 
 public:
     bool loadFromStream(std::ifstream& filestream);
+    bool loadFromData(std::span<const unsigned char> data);
 
     const std::array<unsigned char, HeaderSize>& data() const;
     const unsigned char* headerData() const;
@@ -32,6 +35,13 @@ public:
 
     uint32_t timestamp(const size_t index) const;
 
+    bool isValid(const size_t fileSize) const;
+    bool isValid(const size_t index, const size_t fileSize) const;
+
+    //! @brief Clears the entries of chunks that are not located within the file.
+    //! @return Indices of the cleared entries.
+    std::vector<size_t> clearInvalid(const size_t fileSize);
+
     void setChunkData(const size_t index, const size_t offset, const size_t size,
                       const uint32_t timestamp);
 
@@ -0,0 +1,87 @@
+// Internal headers
+#include "anvil/sector_map.hpp"
+#include "anvil/region_header.hpp"
+
+#include <algorithm>
+
+namespace anvil {
+
+SectorMap::SectorMap(size_t sectorCount)
+    : m_used(sectorCount, false)
+{ }
+
+SectorMap SectorMap::fromHeader(const RegionHeader& header, size_t fileSize,
+                                const std::vector<bool>& ignored)
+{
+    constexpr size_t HeaderSectors = RegionHeader::HeaderSize / RegionHeader::SectorSize;
+
+    size_t fileSectors = (fileSize + RegionHeader::SectorSize - 1) / RegionHeader::SectorSize;
+    SectorMap map(std::max(fileSectors, HeaderSectors));
+    map.markUsed(0, HeaderSectors);
+
+    for(size_t index = 0; index < RegionHeader::Chunks; ++index) {
+        if(header.empty(index) || (index < ignored.size() && ignored[index])) {
+            continue;
+        }
+        map.markUsed(header.offset(index), header.size(index));
+    }
+    return map;
+}
+
+size_t SectorMap::usedSectorCount() const
+{
+    return static_cast<size_t>(std::count(m_used.begin(), m_used.end(), true));
+}
+
+bool SectorMap::isFree(size_t offset, size_t count) const
+{
+    for(size_t sector = offset; sector < offset + count; ++sector) {
+        if(isUsed(sector)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SectorMap::markUsed(size_t offset, size_t count)
+{
+    if(offset + count > m_used.size()) {
+        m_used.resize(offset + count, false);
+    }
+    std::fill_n(m_used.begin() + offset, count, true);
+}
+
+void SectorMap::markFree(size_t offset, size_t count)
+{
+    const size_t end = std::min(offset + count, m_used.size());
+    for(size_t sector = offset; sector < end; ++sector) {
+        m_used[sector] = false;
+    }
+}
+
+size_t SectorMap::allocate(size_t count)
+{
+    // First fit
+    size_t runStart  = 0;
+    size_t runLength = 0;
+    for(size_t sector = 0; sector < m_used.size(); ++sector) {
+        if(m_used[sector]) {
+            runLength = 0;
+            continue;
+        }
+        if(runLength == 0) {
+            runStart = sector;
+        }
+        if(++runLength == count) {
+            markUsed(runStart, count);
+            return runStart;
+        }
+    }
+
+    // Append at the end, a trailing free run is extended.
+    const size_t offset = (runLength > 0) ? runStart : m_used.size();
+    markUsed(offset, count);
+    return offset;
+}
+
+} // namespace anvil
@@ -0,0 +1,52 @@
+#ifndef CPP_ANVIL_ANVIL_SECTOR_MAP_HPP
+#define CPP_ANVIL_ANVIL_SECTOR_MAP_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace anvil {
+
+class RegionHeader;
+
+//! @brief Tracks which sectors of a region file are in use.
+class SectorMap
+{
+public:
+    //! @brief Creates a map of @p sectorCount free sectors.
+    explicit SectorMap(size_t sectorCount = 0);
+
+    //! @brief Creates a map of the sectors referenced by @p header.
+    //! @details
+    //! The two header sectors are always marked as used.
+    //!
+    //! @param header The region header.
+    //! @param fileSize Size of the region file in bytes.
+    //! @param ignored Chunks whose sectors should be treated as free, may be empty.
+    static SectorMap fromHeader(const RegionHeader& header, size_t fileSize,
+                                const std::vector<bool>& ignored = {});
+
+    size_t sectorCount() const { return m_used.size(); }
+    size_t usedSectorCount() const;
+
+    bool isUsed(size_t sector) const { return sector < m_used.size() && m_used[sector]; }
+    bool isFree(size_t offset, size_t count) const;
+
+    void markUsed(size_t offset, size_t count);
+    void markFree(size_t offset, size_t count);
+
+    //! @brief Allocates @p count contiguous sectors.
+    //! @details
+    //! The first free run that is large enough is used. If there is none, the sectors are
+    //! appended to the end of the map.
+    //!
+    //! @param count Number of sectors.
+    //! @return Offset of the first allocated sector.
+    size_t allocate(size_t count);
+
+private:
+    std::vector<bool> m_used;
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_ANVIL_SECTOR_MAP_HPP
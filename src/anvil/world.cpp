@@ -0,0 +1,224 @@
+#include "cpp-anvil/anvil/world.hpp"
+#include "cpp-anvil/anvil/region.hpp"
+
+#include <filesystem>
+
+namespace anvil {
+
+World::World(const std::string& directory, size_t memoryBudget)
+    : m_directory(directory)
+    , m_memoryBudget(memoryBudget)
+{ }
+
+World::~World() = default;
+
+const std::string& World::directory() const
+{
+    return m_directory;
+}
+
+std::string World::regionFilename(const Vec2& regionCoord) const
+{
+    std::filesystem::path path = std::filesystem::path(m_directory) / "region"
+                                 / ("r." + std::to_string(regionCoord.x) + "."
+                                    + std::to_string(regionCoord.z) + ".mca");
+    return path.string();
+}
+
+std::vector<Vec2> World::regionCoordinates() const
+{
+    std::vector<Vec2> coords;
+
+    std::error_code ec;
+    std::filesystem::directory_iterator it(std::filesystem::path(m_directory) / "region", ec);
+    if(ec) {
+        return coords;
+    }
+    for(const auto& entry : it) {
+        Vec2 coord;
+        if(entry.is_regular_file()
+           && Region::validateAndParseRegionFilename(entry.path().string(), coord.x, coord.z)) {
+            coords.push_back(coord);
+        }
+    }
+    return coords;
+}
+
+Region& World::regionAt(const Vec2& regionCoord)
+{
+    return cachedRegion(regionCoord);
+}
+
+const Region& World::regionAt(const Vec2& regionCoord) const
+{
+    return cachedRegion(regionCoord);
+}
+
+Chunk& World::chunkAt(const Vec2& chunkCoord)
+{
+    Region& region    = cachedRegion(chunkWorld2Region(chunkCoord));
+    const Vec2 coord  = chunkWorld2ChunkRegion(chunkCoord);
+    const bool loaded = region.isChunkLoaded(Region::toIndex(coord.x, coord.z));
+
+    Chunk& chunk = region.chunkAt(coord);
+    if(!loaded) {
+        enforceMemoryBudget(&region);
+    }
+    m_accessedChunk = chunkCoord;
+    return chunk;
+}
+
+const Chunk& World::chunkAt(const Vec2& chunkCoord) const
+{
+    const Region& region = cachedRegion(chunkWorld2Region(chunkCoord));
+    const Vec2 coord     = chunkWorld2ChunkRegion(chunkCoord);
+    const bool loaded    = region.isChunkLoaded(Region::toIndex(coord.x, coord.z));
+
+    const Chunk& chunk = region.chunkAt(coord);
+    if(!loaded) {
+        enforceMemoryBudget(&region);
+    }
+    return chunk;
+}
+
+void World::markChunkDirty(const Vec2& chunkCoord)
+{
+    Region& region   = cachedRegion(chunkWorld2Region(chunkCoord));
+    const Vec2 coord = chunkWorld2ChunkRegion(chunkCoord);
+    region.markChunkDirty(Region::toIndex(coord.x, coord.z));
+}
+
+bool World::saveAll()
+{
+    commitAccessedChunk();
+
+    bool success = true;
+    for(auto it = m_regions.begin(); it != m_regions.end();) {
+        Region& region = *it->region;
+        if(!region.hasUnsavedChanges()) {
+            ++it;
+            continue;
+        }
+
+        if(!region.filename().empty()) {
+            success = region.saveChanges() && success;
+            ++it;
+            continue;
+        }
+
+        // New regions are not bound to their file, they are opened again on the next access.
+        const std::string filename = regionFilename(it->coord);
+        std::filesystem::create_directories(std::filesystem::path(filename).parent_path());
+        success = region.saveToFile(filename) && success;
+        m_regionIndex.erase(regionKey(it->coord));
+        it = m_regions.erase(it);
+    }
+    return success;
+}
+
+size_t World::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void World::setMemoryBudget(size_t memoryBudget)
+{
+    m_memoryBudget = memoryBudget;
+    enforceMemoryBudget(nullptr);
+}
+
+size_t World::memoryUsage() const
+{
+    size_t usage = 0;
+    for(const auto& cached : m_regions) {
+        usage += cached.region->memoryUsage();
+    }
+    return usage;
+}
+
+size_t World::cachedRegionCount() const
+{
+    return m_regions.size();
+}
+
+bool World::isRegionCached(const Vec2& regionCoord) const
+{
+    return m_regionIndex.find(regionKey(regionCoord)) != m_regionIndex.end();
+}
+
+Region& World::cachedRegion(const Vec2& regionCoord) const
+{
+    commitAccessedChunk();
+
+    const uint64_t key = regionKey(regionCoord);
+    auto it            = m_regionIndex.find(key);
+    if(it != m_regionIndex.end()) {
+        m_regions.splice(m_regions.begin(), m_regions, it->second);
+        return *m_regions.front().region;
+    }
+
+    CachedRegion cached;
+    cached.coord  = regionCoord;
+    cached.region = std::make_unique<Region>();
+    cached.region->setLazyLoading(true);
+
+    std::error_code ec;
+    const std::string filename = regionFilename(regionCoord);
+    if(std::filesystem::exists(filename, ec)) {
+        cached.region->loadPartiallyFromFile(filename);
+    }
+
+    m_regions.push_front(std::move(cached));
+    m_regionIndex[key] = m_regions.begin();
+
+    Region& region = *m_regions.front().region;
+    enforceMemoryBudget(&region);
+    return region;
+}
+
+void World::enforceMemoryBudget(const Region* keep) const
+{
+    commitAccessedChunk();
+
+    size_t usage = memoryUsage();
+    for(auto it = m_regions.end(); it != m_regions.begin() && usage > m_memoryBudget;) {
+        --it;
+        const Region& region = *it->region;
+        if(&region == keep || region.hasUnsavedChanges()) {
+            continue;
+        }
+
+        usage -= region.memoryUsage();
+        m_regionIndex.erase(regionKey(it->coord));
+        it = m_regions.erase(it);
+    }
+
+    // The remaining regions have unsaved changes, their unmodified chunks can still be released.
+    for(auto it = m_regions.rbegin(); it != m_regions.rend() && usage > m_memoryBudget; ++it) {
+        Region& region = *it->region;
+        if(&region == keep) {
+            continue;
+        }
+
+        usage -= region.memoryUsage();
+        region.unloadAll();
+        usage += region.memoryUsage();
+    }
+}
+
+void World::commitAccessedChunk() const
+{
+    if(!m_accessedChunk) {
+        return;
+    }
+    const Vec2 chunkCoord = *m_accessedChunk;
+    m_accessedChunk.reset();
+
+    auto it = m_regionIndex.find(regionKey(chunkWorld2Region(chunkCoord)));
+    if(it != m_regionIndex.end()) {
+        const Vec2 coord = chunkWorld2ChunkRegion(chunkCoord);
+        it->second->region->commitChunk(Region::toIndex(coord.x, coord.z));
+    }
+}
+
+} // namespace anvil
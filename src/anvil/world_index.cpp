@@ -0,0 +1,131 @@
+#include "cpp-anvil/anvil/world_index.hpp"
+#include "cpp-anvil/anvil/region.hpp"
+
+// Internal headers
+#include "anvil/region_header.hpp"
+#include "util/parallel.hpp"
+#include "util/random_access_file.hpp"
+
+#include <filesystem>
+#include <memory>
+
+namespace anvil {
+
+WorldIndex WorldIndex::scan(const std::string& directory, size_t threadCount)
+{
+    // Collect the region files first, the headers are read in parallel afterwards.
+    std::vector<std::string> filenames;
+    std::vector<Vec2> coords;
+    std::error_code ec;
+    std::filesystem::directory_iterator it(std::filesystem::path(directory) / "region", ec);
+    if(!ec) {
+        for(const auto& entry : it) {
+            Vec2 coord;
+            if(entry.is_regular_file()
+               && Region::validateAndParseRegionFilename(entry.path().string(), coord.x, coord.z)) {
+                filenames.push_back(entry.path().string());
+                coords.push_back(coord);
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<RegionEntry>> entries(filenames.size());
+    detail::parallelFor(filenames.size(), threadCount, [&filenames, &entries](size_t i) {
+        RandomAccessFile file;
+        std::vector<unsigned char> headerData(RegionHeader::HeaderSize);
+        RegionHeader header;
+        if(!file.open(filenames[i])
+           || file.readAt(0, headerData.data(), headerData.size()) != headerData.size()
+           || !header.loadFromData(headerData)) {
+            return;
+        }
+
+        auto entry = std::make_unique<RegionEntry>();
+        for(size_t index = 0; index < ChunksPerRegion; ++index) {
+            if(header.empty(index) || !header.isValid(index, file.size())) {
+                continue;
+            }
+            entry->present.set(index);
+            entry->sectors[index]    = static_cast<uint8_t>(header.size(index));
+            entry->timestamps[index] = header.timestamp(index);
+        }
+        entries[i] = std::move(entry);
+    });
+
+    WorldIndex index;
+    for(size_t i = 0; i < entries.size(); ++i) {
+        if(entries[i]) {
+            index.m_regions.emplace(regionKey(coords[i]), *entries[i]);
+        } else {
+            ++index.m_skippedRegions;
+        }
+    }
+    return index;
+}
+
+size_t WorldIndex::regionCount() const
+{
+    return m_regions.size();
+}
+
+size_t WorldIndex::chunkCount() const
+{
+    size_t count = 0;
+    for(const auto& [key, entry] : m_regions) {
+        count += entry.present.count();
+    }
+    return count;
+}
+
+size_t WorldIndex::skippedRegionCount() const
+{
+    return m_skippedRegions;
+}
+
+std::vector<Vec2> WorldIndex::regionCoordinates() const
+{
+    std::vector<Vec2> coords;
+    coords.reserve(m_regions.size());
+    for(const auto& [key, entry] : m_regions) {
+        Vec2 coord;
+        coord.x = static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+        coord.z = static_cast<int32_t>(static_cast<uint32_t>(key & 0xFFFFFFFFu));
+        coords.push_back(coord);
+    }
+    return coords;
+}
+
+bool WorldIndex::contains(const Vec2& chunkCoord) const
+{
+    size_t index             = 0;
+    const RegionEntry* entry = findChunk(chunkCoord, index);
+    return entry && entry->present.test(index);
+}
+
+size_t WorldIndex::sectorCount(const Vec2& chunkCoord) const
+{
+    size_t index             = 0;
+    const RegionEntry* entry = findChunk(chunkCoord, index);
+    return entry ? entry->sectors[index] : 0;
+}
+
+uint32_t WorldIndex::timestamp(const Vec2& chunkCoord) const
+{
+    size_t index             = 0;
+    const RegionEntry* entry = findChunk(chunkCoord, index);
+    return entry ? entry->timestamps[index] : 0;
+}
+
+const WorldIndex::RegionEntry* WorldIndex::findChunk(const Vec2& chunkCoord, size_t& index) const
+{
+    auto it = m_regions.find(regionKey(chunkWorld2Region(chunkCoord)));
+    if(it == m_regions.end()) {
+        return nullptr;
+    }
+
+    const Vec2 coord = chunkWorld2ChunkRegion(chunkCoord);
+    index            = Region::toIndex(coord.x, coord.z);
+    return &it->second;
+}
+
+} // namespace anvil
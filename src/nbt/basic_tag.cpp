@@ -6,6 +6,11 @@
 
 namespace anvil {
 
+void BasicTag::notifyRenamed(const StringType* previous) noexcept
+{
+    m_parent->renameChild(this, previous);
+}
+
 EndTag* BasicTag::asEndTag()
 {
     return tag_cast<EndTag*>(this);
@@ -1,43 +1,199 @@
 #include "cpp-anvil/nbt/compound_tag.hpp"
 
 #include <algorithm>
+#include <functional>
+#include <utility>
 
 namespace anvil {
 
-bool CompoundTag::hasChild(const std::string& name) const
+namespace {
+
+// Interned names are ordered by their address.
+constexpr std::less<const StringType*> nameLess;
+
+constexpr auto compareName = [](const auto& entry, const StringType* name) {
+    return nameLess(entry.name, name);
+};
+
+} // namespace
+
+bool CompoundTag::hasChild(std::string_view name) const
 {
-    for(const auto& tag : m_value) {
-        if(tag->name() == name) {
-            return true;
-        }
+    return getChildByName(name) != nullptr;
+}
+
+BasicTag* CompoundTag::getChildByName(std::string_view name)
+{
+    return const_cast<BasicTag*>(std::as_const(*this).getChildByName(name));
+}
+
+const BasicTag* CompoundTag::getChildByName(std::string_view name) const
+{
+    // Names are interned, a name that was never interned can not be found.
+    const StringType* interned = detail::findName(name);
+    if(interned == nullptr) {
+        return nullptr;
     }
-    return false;
+    return findChild(interned);
+}
+
+const BasicTag* CompoundTag::findChild(const StringType* name) const
+{
+    if(m_index.empty()) {
+        return findFirstChild(name);
+    }
+
+    // The index covers every child, a missing entry means there is no child with the name.
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), name, compareName);
+    if(it != m_index.end() && it->name == name) {
+        return it->child;
+    }
+    return nullptr;
 }
 
-BasicTag* CompoundTag::getChildByName(const std::string& name)
+BasicTag* CompoundTag::findFirstChild(const StringType* name) const
 {
     for(const auto& tag : m_value) {
-        if(tag->name() == name) {
+        if(&std::as_const(*tag).name() == name) {
             return tag.get();
         }
     }
     return nullptr;
 }
 
-const BasicTag* CompoundTag::getChildByName(const std::string& name) const
+void CompoundTag::buildIndex()
 {
+    m_index.clear();
+    m_index.reserve(size());
     for(const auto& tag : m_value) {
-        if(tag->name() == name) {
-            return tag.get();
+        m_index.push_back({&std::as_const(*tag).name(), tag.get(), 1});
+    }
+
+    // Keep the first child of duplicate names, like the linear search does.
+    std::stable_sort(m_index.begin(), m_index.end(), [](const auto& lhs, const auto& rhs) {
+        return nameLess(lhs.name, rhs.name);
+    });
+    auto last = m_index.begin();
+    for(auto it = m_index.begin(); it != m_index.end(); ++it) {
+        if(it == last) {
+            continue;
+        }
+        if(it->name == last->name) {
+            ++last->count;
+        } else {
+            *++last = *it;
         }
     }
-    return nullptr;
+    if(!m_index.empty()) {
+        m_index.erase(last + 1, m_index.end());
+    }
+}
+
+void CompoundTag::attachChildren()
+{
+    for(auto& tag : m_value) {
+        tag->m_parent = this;
+    }
+    updateIndex();
+}
+
+void CompoundTag::updateIndex()
+{
+    if(size() >= IndexThreshold) {
+        buildIndex();
+    } else {
+        m_index.clear();
+    }
+}
+
+void CompoundTag::indexChild(BasicTag* child)
+{
+    if(m_index.empty()) {
+        if(size() >= IndexThreshold) {
+            buildIndex();
+        }
+        return;
+    }
+
+    const StringType* name = &std::as_const(*child).name();
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), name, compareName);
+    if(it == m_index.end() || it->name != name) {
+        m_index.insert(it, {name, child, 1});
+    } else {
+        // Only duplicate names need a search for the first child.
+        ++it->count;
+        it->child = findFirstChild(name);
+    }
+}
+
+void CompoundTag::unindexChild(BasicTag* child, const StringType* name)
+{
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), name, compareName);
+    if(it == m_index.end() || it->name != name) {
+        return;
+    }
+    if(it->count == 1) {
+        m_index.erase(it);
+        return;
+    }
+    --it->count;
+    if(it->child == child) {
+        it->child = findFirstChild(name);
+    }
+}
+
+void CompoundTag::renameChild(BasicTag* child, const StringType* previous) noexcept
+{
+    if(m_index.empty()) {
+        return;
+    }
+    try {
+        unindexChild(child, previous);
+        indexChild(child);
+    } catch(...) {
+        // Without the index the children are searched linearly.
+        m_index.clear();
+    }
+}
+
+std::unique_ptr<BasicTag> CompoundTag::removeAt(size_type index)
+{
+    std::unique_ptr<BasicTag> tag = std::move(m_value[index]);
+    m_value.erase(m_value.begin() + index);
+    tag->m_parent = nullptr;
+    if(!m_index.empty()) {
+        unindexChild(tag.get(), &std::as_const(*tag).name());
+    }
+    return tag;
+}
+
+CompoundTag& CompoundTag::operator=(const CompoundTag& other)
+{
+    if(this != &other) {
+        BasicTag::operator=(other);
+        copy(other.m_value);
+    }
+    return *this;
+}
+
+CompoundTag& CompoundTag::operator=(CompoundTag&& other) noexcept
+{
+    if(this != &other) {
+        CollectionTag::operator=(std::move(other));
+        m_index = std::exchange(other.m_index, {});
+        for(auto& tag : m_value) {
+            tag->m_parent = this;
+        }
+    }
+    return *this;
 }
 
 bool CompoundTag::push_back(std::unique_ptr<BasicTag> value)
 {
     if(value) {
+        value->m_parent = this;
         m_value.push_back(std::move(value));
+        indexChild(m_value.back().get());
         return true;
     }
     return false;
@@ -45,49 +201,86 @@ bool CompoundTag::push_back(std::unique_ptr<BasicTag> value)
 
 bool CompoundTag::push_back(BasicTag* value)
 {
-    if(value) {
-        m_value.push_back(std::unique_ptr<BasicTag>(value));
-        return true;
-    }
-    return false;
+    return push_back(std::unique_ptr<BasicTag>(value));
 }
 
 bool CompoundTag::push_back(const BasicTag& value)
 {
-    m_value.push_back(value.clone());
-    return true;
+    return push_back(value.clone());
+}
+
+std::unique_ptr<BasicTag> CompoundTag::replaceAt(size_type index, std::unique_ptr<BasicTag> value)
+{
+    if(index >= size() || !value) {
+        return {};
+    }
+
+    value->m_parent                    = this;
+    std::unique_ptr<BasicTag> previous = std::exchange(m_value[index], std::move(value));
+    previous->m_parent                 = nullptr;
+    if(!m_index.empty()) {
+        unindexChild(previous.get(), &std::as_const(*previous).name());
+    }
+    indexChild(m_value[index].get());
+    return previous;
 }
 
 std::unique_ptr<BasicTag> CompoundTag::takeAt(size_type index)
 {
-    std::unique_ptr<BasicTag> val = std::move(m_value[index]);
-    eraseAt(index);
-    return val;
+    if(index >= size()) {
+        return {};
+    }
+    return removeAt(index);
 }
 
 std::unique_ptr<BasicTag> CompoundTag::take(BasicTag* tag)
 {
-    std::unique_ptr<BasicTag> val;
-    auto it =
-        std::find_if(m_value.begin(), m_value.end(),
-                     [tag](const std::unique_ptr<BasicTag>& ptr) { return ptr.get() == tag; });
-    if(it != m_value.end()) {
-        val = std::move(*it);
-        m_value.erase(it);
+    const size_type index = indexOf(tag);
+    if(index >= size()) {
+        return {};
     }
-    return val;
+    return removeAt(index);
 }
 
 bool CompoundTag::erase(BasicTag* tag)
 {
-    auto it =
-        std::find_if(m_value.begin(), m_value.end(),
-                     [tag](const std::unique_ptr<BasicTag>& ptr) { return ptr.get() == tag; });
-    if(it != m_value.end()) {
-        m_value.erase(it);
-        return true;
+    return take(tag) != nullptr;
+}
+
+bool CompoundTag::eraseAt(size_type index)
+{
+    return takeAt(index) != nullptr;
+}
+
+void CompoundTag::clear()
+{
+    m_value.clear();
+    m_index.clear();
+}
+
+void CompoundTag::swap(size_t indexA, size_t indexB)
+{
+    std::swap(m_value[indexA], m_value[indexB]);
+
+    // Either child may now be the first one of a duplicate name.
+    for(size_t index : {indexA, indexB}) {
+        const StringType* name = &std::as_const(*m_value[index]).name();
+        auto it = std::lower_bound(m_index.begin(), m_index.end(), name, compareName);
+        if(it != m_index.end() && it->name == name && it->count > 1) {
+            it->child = findFirstChild(name);
+        }
     }
-    return false;
+}
+
+void CompoundTag::setValue(const ContainerType<value_type>& value)
+{
+    copy(value);
+}
+
+void CompoundTag::copy(const ContainerType<value_type>& otherValue)
+{
+    CollectionTag::copy(otherValue);
+    attachChildren();
 }
 
 } // namespace anvil
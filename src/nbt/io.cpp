@@ -1,14 +1,18 @@
 #include "cpp-anvil/nbt/io.hpp"
+#include "cpp-anvil/nbt/parser.hpp"
+#include "cpp-anvil/nbt/tag_arena.hpp"
 #include "cpp-anvil/util/compression.hpp"
 
 // Internal headers
 #include "util/nbt_byte_stream.hpp"
 
 // STL
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace anvil {
@@ -30,6 +34,16 @@ bool readFile(std::ifstream& strm, std::vector<unsigned char>& data)
     return true;
 }
 
+bool inflateLz4(std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> uncompressed;
+    if(!inflate_lz4(data, uncompressed)) {
+        return false;
+    }
+    data = std::move(uncompressed);
+    return true;
+}
+
 bool isNbtFile(const std::string& filename)
 {
     if(!std::filesystem::exists(filename)) {
@@ -38,11 +52,13 @@ bool isNbtFile(const std::string& filename)
 
     std::ifstream file(filename, std::ios::binary);
     if(file.is_open()) {
-        // Read first 2 bytes from binary data. These bytes indicate if the file is uncompressed or
-        // either Zlib or Gzip compressed.
-        std::vector<unsigned char> buffer(2, 0);
-        file.read(reinterpret_cast<char*>(&buffer[0]), 2);
-        if(!file || file.gcount() != 2) {
+        // Read first 8 bytes from binary data. These bytes indicate if the file is uncompressed or
+        // either Zlib, Gzip or LZ4 compressed. Smaller files can only be uncompressed.
+        std::vector<unsigned char> buffer(8, 0);
+        file.read(reinterpret_cast<char*>(&buffer[0]), 8);
+        buffer.resize(file.gcount());
+        file.clear();
+        if(buffer.size() < 2) {
             return false;
         }
         CompressionType compressionType = testCompression(buffer);
@@ -55,6 +71,8 @@ bool isNbtFile(const std::string& filename)
             ret = inflate_gzip(file, data);
         } else if(compressionType == CompressionType::Zlib) {
             ret = inflate_zlib(file, data);
+        } else if(compressionType == CompressionType::Lz4) {
+            ret = readFile(file, data) && inflateLz4(data);
         } else {
             ret = readFile(file, data);
         }
@@ -92,11 +110,13 @@ std::unique_ptr<CompoundTag> loadFromFile(const std::string& filename,
 
     std::ifstream file(filename, std::ios::binary);
     if(file.is_open()) {
-        // Read first 2 bytes from binary data. These bytes indicate if the file is uncompressed or
-        // either Zlib or Gzip compressed.
-        std::vector<unsigned char> buffer(2, 0);
-        file.read(reinterpret_cast<char*>(&buffer[0]), 2);
-        if(!file || file.gcount() != 2) {
+        // Read first 8 bytes from binary data. These bytes indicate if the file is uncompressed or
+        // either Zlib, Gzip or LZ4 compressed. Smaller files can only be uncompressed.
+        std::vector<unsigned char> buffer(8, 0);
+        file.read(reinterpret_cast<char*>(&buffer[0]), 8);
+        buffer.resize(file.gcount());
+        file.clear();
+        if(buffer.size() < 2) {
             return {};
         }
         compressionType = testCompression(buffer);
@@ -109,6 +129,8 @@ std::unique_ptr<CompoundTag> loadFromFile(const std::string& filename,
             ret = inflate_gzip(file, data);
         } else if(compressionType == CompressionType::Zlib) {
             ret = inflate_zlib(file, data);
+        } else if(compressionType == CompressionType::Lz4) {
+            ret = readFile(file, data) && inflateLz4(data);
         } else {
             ret = readFile(file, data);
         }
@@ -161,6 +183,15 @@ bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
         case CompressionType::Uncompressed:
             ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
             break;
+        case CompressionType::Lz4: {
+            std::vector<unsigned char> compressed;
+            ret = deflate_lz4(data, compressed);
+            ofs.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+            break;
+        }
+        default:
+            ret = false;
+            break;
     }
 
     ofs.close();
@@ -168,6 +199,30 @@ bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
     return ret;
 }
 
+bool saveToFile(const std::string& filename, std::vector<unsigned char>& data,
+                CompressionType compressionType, int compressionLevel, size_t threadCount)
+{
+    if(threadCount == 1
+       || (compressionType != CompressionType::Gzip && compressionType != CompressionType::Zlib)) {
+        return saveToFile(filename, data, compressionType, compressionLevel);
+    }
+
+    std::vector<unsigned char> compressed;
+    const bool ret = compressionType == CompressionType::Gzip
+                         ? deflate_gzip(data, compressed, compressionLevel, threadCount)
+                         : deflate_zlib(data, compressed, compressionLevel, threadCount);
+    if(!ret) {
+        return false;
+    }
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if(!ofs.is_open()) {
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+    return ofs.good();
+}
+
 bool saveToFile(const std::string& filename, const CompoundTag* compoundTag)
 {
     return saveToFile(filename, compoundTag, CompressionType::Uncompressed, DefaultCompression);
@@ -187,160 +242,181 @@ bool saveToFile(const std::string& filename, const CompoundTag* compoundTag,
     return saveToFile(filename, data, compressionType, compressionLevel);
 }
 
-std::unique_ptr<BasicTag> readChildTag(NbtInputByteStream& byteStream, bool isListItem = false,
-                                       TagType listTag = TagType::End)
+bool saveToFile(const std::string& filename, const CompoundTag* compoundTag,
+                CompressionType compressionType, int compressionLevel, size_t threadCount)
 {
-    TagType tagType;
-    StringType name;
+    std::vector<unsigned char> data = writeData(compoundTag);
+
+    return saveToFile(filename, data, compressionType, compressionLevel, threadCount);
+}
 
-    // ListItems do not have tag types and do not have names
-    if(isListItem) {
-        tagType = listTag;
-    } else {
-        tagType = byteStream.read<TagType>();
+namespace {
 
-        // EndTags do not have names
-        if(tagType != TagType::End) {
-            name = byteStream.read<StringType>();
+//! @brief Builds the tag tree from the events of the parser.
+class TagBuilder : public NbtHandler
+{
+public:
+    explicit TagBuilder(const ReadOptions& options)
+        : m_options(options)
+    { }
+
+    std::unique_ptr<CompoundTag> takeRoot() { return std::move(m_root); }
+
+    void beginCompound(std::string_view name) override
+    {
+        auto compoundTag = makeTag<CompoundTag>();
+        CompoundTag* tag = compoundTag.get();
+        if(m_containers.empty()) {
+            tag->setInternedName(m_names.intern(name));
+            m_root = std::move(compoundTag);
+        } else {
+            add(name, std::move(compoundTag));
         }
+        m_containers.push_back(tag);
     }
 
-    // Read data from stream depending on the tag type
-    std::unique_ptr<BasicTag> tag;
-    switch(tagType) {
-        case TagType::End:
-            tag = std::make_unique<EndTag>();
-            break;
-        case TagType::Byte:
-        {
-            auto value = byteStream.read<ByteType>();
-            tag        = std::make_unique<ByteTag>(name, value);
-            break;
-        }
-        case TagType::Short:
-        {
-            auto value = byteStream.read<ShortType>();
-            tag        = std::make_unique<ShortTag>(name, value);
-            break;
-        }
-        case TagType::Int:
-        {
-            auto value = byteStream.read<IntType>();
-            tag        = std::make_unique<IntTag>(name, value);
-            break;
+    // The index of the child names is built by push_back().
+    void endCompound() override { m_containers.pop_back(); }
+
+    void beginList(std::string_view name, TagType elementType, size_t size) override
+    {
+        auto listTag = makeTag<ListTag>(StringType(), elementType);
+        ListTag* tag = listTag.get();
+        // Numbers are stored packed on request, the size is not trusted for large reservations.
+        if(m_options.packLists && tag->pack()) {
+            tag->reserve(std::min<size_t>(size, MaxListReserve));
         }
-        case TagType::Long:
-        {
-            auto value = byteStream.read<LongType>();
-            tag        = std::make_unique<LongTag>(name, value);
-            break;
+        add(name, std::move(listTag));
+        m_containers.push_back(tag);
+    }
+
+    void endList() override { m_containers.pop_back(); }
+
+    void value(std::string_view name, ByteType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<ByteTag>(value));
         }
-        case TagType::Float:
-        {
-            auto value = byteStream.read<FloatType>();
-            tag        = std::make_unique<FloatTag>(name, value);
-            break;
+    }
+
+    void value(std::string_view name, ShortType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<ShortTag>(value));
         }
-        case TagType::Double:
-        {
-            auto value = byteStream.read<DoubleType>();
-            tag        = std::make_unique<DoubleTag>(name, value);
-            break;
+    }
+
+    void value(std::string_view name, IntType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<IntTag>(value));
         }
-        case TagType::ByteArray:
-        {
-            auto value = byteStream.read<std::vector<ByteType>>();
-            tag        = std::make_unique<ByteArrayTag>(name, value);
-            break;
+    }
+
+    void value(std::string_view name, LongType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<LongTag>(value));
         }
-        case TagType::String:
-        {
-            auto value = byteStream.read<StringType>();
-            tag        = std::make_unique<StringTag>(name, value);
-            break;
+    }
+
+    void value(std::string_view name, FloatType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<FloatTag>(value));
         }
-        case TagType::List:
-        {
-            TagType listTagType = byteStream.read<TagType>();
-            auto listTag        = std::make_unique<ListTag>(name, listTagType);
-            std::unique_ptr<BasicTag> childTag;
-
-            const int32_t size = byteStream.read<int32_t>();
-            for(int32_t i = 0; i < size; ++i) {
-                childTag = readChildTag(byteStream, true, listTagType);
-                listTag->push_back(std::move(childTag));
-            }
-            tag = std::move(listTag);
+    }
 
-            break;
+    void value(std::string_view name, DoubleType value) override
+    {
+        if(!appendToList(value)) {
+            add(name, makeTag<DoubleTag>(value));
         }
-        case TagType::Compound:
-        {
-            auto compoundTag = std::make_unique<CompoundTag>(name);
-            TagType childTagType{TagType::Unknown};
-            do {
-                std::unique_ptr<BasicTag> childTag = readChildTag(byteStream);
-                if(!childTag) {
-                    throw std::runtime_error("Failed to read child tag.");
-                }
-                childTagType = childTag->type();
-                if(childTagType != TagType::End) {
-                    compoundTag->push_back(std::move(childTag));
-                }
-            } while(childTagType != TagType::End);
-            tag = std::move(compoundTag);
-            break;
+    }
+
+    void value(std::string_view name, std::string_view value) override
+    {
+        add(name, makeTag<StringTag>(StringType(value)));
+    }
+
+    void array(std::string_view name, std::span<const ByteType> values) override
+    {
+        auto tag = makeTag<ByteArrayTag>();
+        tag->value().assign(values.begin(), values.end());
+        add(name, std::move(tag));
+    }
+
+    void array(std::string_view name, std::span<const IntType> values) override
+    {
+        auto tag = makeTag<IntArrayTag>();
+        tag->value().assign(values.begin(), values.end());
+        add(name, std::move(tag));
+    }
+
+    void array(std::string_view name, std::span<const LongType> values) override
+    {
+        auto tag = makeTag<LongArrayTag>();
+        tag->value().assign(values.begin(), values.end());
+        add(name, std::move(tag));
+    }
+
+private:
+    constexpr static size_t MaxListReserve{64u * 1024u};
+
+    //! @brief Creates a tag in the arena of the current scope, if any.
+    template<typename T, typename... Args>
+    std::unique_ptr<T> makeTag(Args&&... args)
+    {
+        if(m_arena != nullptr) {
+            return m_arena->make<T>(std::forward<Args>(args)...);
         }
-        case TagType::IntArray:
-        {
-            auto value = byteStream.read<std::vector<IntType>>();
-            tag        = std::make_unique<IntArrayTag>(name, value);
-            break;
+        return std::make_unique<T>(std::forward<Args>(args)...);
+    }
+
+    //! @brief Appends @p value to the current container if it is a packed list.
+    template<PackableListType T>
+    bool appendToList(T value)
+    {
+        BasicTag* parent = m_containers.back();
+        if(parent->type() != TagType::List) {
+            return false;
         }
-        case TagType::LongArray:
-        {
-            auto value = byteStream.read<std::vector<LongType>>();
-            tag        = std::make_unique<LongArrayTag>(name, value);
-            break;
+        auto* listTag = static_cast<ListTag*>(parent);
+        return listTag->isPacked() && listTag->appendValue(value);
+    }
+
+    void add(std::string_view name, std::unique_ptr<BasicTag> tag)
+    {
+        tag->setInternedName(m_names.intern(name));
+
+        BasicTag* parent = m_containers.back();
+        if(parent->type() == TagType::Compound) {
+            static_cast<CompoundTag*>(parent)->push_back(std::move(tag));
+        } else {
+            static_cast<ListTag*>(parent)->push_back(std::move(tag));
         }
-        case TagType::Unknown:
-        default:
-            throw std::runtime_error("Invalid tag type.");
     }
 
-    return tag;
-}
+private:
+    ReadOptions m_options;
+    std::unique_ptr<CompoundTag> m_root;
+    std::vector<BasicTag*> m_containers;
+    detail::NameCache m_names;
+    TagArena* m_arena{TagArena::current()};
+};
+
+} // namespace
 
 std::unique_ptr<CompoundTag> readData(std::vector<unsigned char>& data)
 {
-    NbtInputByteStream byteStream(data);
-    TagType tag = byteStream.read<TagType>();
-    if(tag == TagType::Unknown) {
-        throw std::runtime_error("Invalid tag type.");
-    } else if(tag != TagType::Compound) {
-        throw std::runtime_error("First tag must be of type CompoundTag.");
-    } else {
-        StringType name = byteStream.read<StringType>();
-
-        std::unique_ptr<CompoundTag> root = std::make_unique<CompoundTag>(name);
-
-        TagType childTagType{TagType::Unknown};
-        std::unique_ptr<BasicTag> childTag;
-        do {
-            childTag = readChildTag(byteStream);
-            if(!childTag) {
-                throw std::runtime_error("Failed to read child tag.");
-            }
-            childTagType = childTag->type();
-            if(childTagType != TagType::End) {
-                root->push_back(std::move(childTag));
-            }
-        } while(childTagType != TagType::End);
-
-        return root;
-    }
+    return readData(data, ReadOptions());
+}
 
-    return {};
+std::unique_ptr<CompoundTag> readData(std::vector<unsigned char>& data, const ReadOptions& options)
+{
+    TagBuilder builder(options);
+    parseData(data, builder);
+    return builder.takeRoot();
 }
 
 void writeTag(NbtOutputByteStream& byteStream, const BasicTag* basicTag, bool isListItem = false,
@@ -417,8 +493,15 @@ void writeTag(NbtOutputByteStream& byteStream, const BasicTag* basicTag, bool is
             const auto* listTag = static_cast<const ListTag*>(basicTag);
             byteStream.write(listTag->listType());
             byteStream.write(static_cast<int32_t>(listTag->size()));
-            for(const auto& value : listTag->value()) {
-                writeTag(byteStream, value.get(), true, listTag->listType());
+            const bool isPacked = listTag->visitValues([&byteStream](auto values) {
+                for(const auto value : values) {
+                    byteStream.write(value);
+                }
+            });
+            if(!isPacked) {
+                for(const auto& value : listTag->value()) {
+                    writeTag(byteStream, value.get(), true, listTag->listType());
+                }
             }
             break;
         }
@@ -548,9 +631,18 @@ void printChildTag(std::stringstream& sstrm, const BasicTag* tag, int indent,
 
             sstrm << t->size() << " entries of type " << getTagTypeName(t->listType());
             sstrm << '\n' << indentStr << "{\n";
-            for(const auto& child : *t) {
-                printChildTag(sstrm, child.get(), indent, current_indent + indent,
-                              printArrayContent);
+            const bool isPacked = t->visitValues([&]<typename T>(std::span<const T> values) {
+                for(const T value : values) {
+                    const PrimitiveTag<T, detail::listTypeOf<T>()> child(value);
+                    printChildTag(sstrm, &child, indent, current_indent + indent,
+                                  printArrayContent);
+                }
+            });
+            if(!isPacked) {
+                for(const auto& child : *t) {
+                    printChildTag(sstrm, child.get(), indent, current_indent + indent,
+                                  printArrayContent);
+                }
             }
             sstrm << indentStr << "}\n";
             break;
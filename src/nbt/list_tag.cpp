@@ -1,17 +1,150 @@
 #include "cpp-anvil/nbt/list_tag.hpp"
+#include "cpp-anvil/nbt/primitive_tag.hpp"
 
 #include <algorithm>
+#include <type_traits>
 
 namespace anvil {
 
+namespace {
+
+template<PackableListType T>
+using PackedTag = PrimitiveTag<T, detail::listTypeOf<T>()>;
+
+template<typename Values>
+constexpr bool IsPackedValues_v = !std::is_same_v<Values, ContainerType<ListTag::value_type>>;
+
+//! @brief Compares the tags of a list with the values of a packed list.
+bool equalElements(const ContainerType<ListTag::value_type>& tags, const ListTag& packed)
+{
+    bool equal = true;
+    packed.visitValues([&tags, &equal]<typename T>(std::span<const T> values) {
+        for(size_t i = 0; i < values.size() && equal; ++i) {
+            equal = tags[i] && *tags[i] == PackedTag<T>(values[i]);
+        }
+    });
+    return equal;
+}
+
+} // namespace
+
+ListTag::ListTag(const ListTag& other)
+    : BasicTag(other)
+    , m_listType(other.m_listType)
+{
+    std::visit(
+        [this]<typename Values>(const Values& values) {
+            if constexpr(IsPackedValues_v<Values>) {
+                m_elements = values;
+            } else {
+                copy(values);
+            }
+        },
+        other.m_elements);
+}
+
+ListTag& ListTag::operator=(const ListTag& other)
+{
+    if(this != &other) {
+        *this = ListTag(other);
+    }
+    return *this;
+}
+
+bool ListTag::pack()
+{
+    if(isPacked()) {
+        return true;
+    }
+
+    switch(m_listType) {
+    case TagType::Byte:
+        return packAs<ByteType>();
+    case TagType::Short:
+        return packAs<ShortType>();
+    case TagType::Int:
+        return packAs<IntType>();
+    case TagType::Long:
+        return packAs<LongType>();
+    case TagType::Float:
+        return packAs<FloatType>();
+    case TagType::Double:
+        return packAs<DoubleType>();
+    default:
+        return false;
+    }
+}
+
+void ListTag::unpack()
+{
+    ContainerType<value_type> tags;
+    const bool packed = visitValues([&tags]<typename T>(std::span<const T> values) {
+        tags.reserve(values.size());
+        for(const T& value : values) {
+            tags.push_back(std::make_unique<PackedTag<T>>(value));
+        }
+    });
+    if(packed) {
+        m_elements = std::move(tags);
+    }
+}
+
+ContainerType<ListTag::value_type>& ListTag::tags()
+{
+    if(auto* tags = std::get_if<0>(&m_elements)) {
+        return *tags;
+    }
+    throw std::runtime_error("List is packed.");
+}
+
+void ListTag::copy(const ContainerType<value_type>& otherValue)
+{
+    ContainerType<value_type> tags;
+    tags.reserve(otherValue.size());
+    for(const auto& tag : otherValue) {
+        tags.push_back(tag->clone());
+    }
+    m_elements = std::move(tags);
+}
+
+size_t ListTag::indexOf(BasicTag* value) const
+{
+    const auto* tags = std::get_if<0>(&m_elements);
+    for(size_t idx = 0; tags != nullptr && idx < tags->size(); ++idx) {
+        if((*tags)[idx].get() == value) {
+            return idx;
+        }
+    }
+    return static_cast<size_t>(-1);
+}
+
+ListTag::size_type ListTag::size() const
+{
+    return std::visit([](const auto& elements) -> size_type { return elements.size(); },
+                      m_elements);
+}
+
+void ListTag::reserve(size_type capacity)
+{
+    std::visit([capacity](auto& elements) { elements.reserve(capacity); }, m_elements);
+}
+
+void ListTag::clear()
+{
+    std::visit([](auto& elements) { elements.clear(); }, m_elements);
+}
+
 bool ListTag::push_back(std::unique_ptr<BasicTag> value)
 {
+    if(value && isPacked()) {
+        return appendTagValue(*value);
+    }
     if(value) {
         if(empty()) {
             m_listType = value->type();
         }
         if(value->type() == m_listType) {
-            m_value.push_back(std::move(value));
+            tags().push_back(std::move(value));
             return true;
         }
     }
@@ -20,12 +153,19 @@ bool ListTag::push_back(std::unique_ptr<BasicTag> value)
 
 bool ListTag::push_back(BasicTag* value)
 {
+    if(value && isPacked()) {
+        if(!appendTagValue(*value)) {
+            return false;
+        }
+        delete value;
+        return true;
+    }
     if(value) {
         if(empty()) {
             m_listType = value->type();
         }
         if(value->type() == m_listType) {
-            m_value.push_back(std::unique_ptr<BasicTag>(value));
+            tags().push_back(std::unique_ptr<BasicTag>(value));
             return true;
         }
     }
@@ -34,46 +174,136 @@ bool ListTag::push_back(BasicTag* value)
 
 bool ListTag::push_back(const BasicTag& value)
 {
+    if(isPacked()) {
+        return appendTagValue(value);
+    }
+
     if(empty()) {
         m_listType = value.type();
     }
     if(value.type() == m_listType) {
-        m_value.push_back(value.clone());
+        tags().push_back(value.clone());
         return true;
     }
     return false;
 }
 
+bool ListTag::appendTagValue(const BasicTag& value)
+{
+    if(value.type() != m_listType) {
+        // Empty lists take the type of the new element.
+        if(!empty()) {
+            return false;
+        }
+        m_elements = ContainerType<value_type>();
+        m_listType = value.type();
+        tags().push_back(value.clone());
+        return true;
+    }
+
+    std::visit(
+        [&value]<typename Values>(Values& values) {
+            if constexpr(IsPackedValues_v<Values>) {
+                using T = typename Values::value_type;
+                values.push_back(static_cast<const PackedTag<T>&>(value).value());
+            }
+        },
+        m_elements);
+    return true;
+}
+
+bool ListTag::eraseAt(size_type index)
+{
+    if(index >= size()) {
+        return false;
+    }
+    std::visit([index](auto& elements) { elements.erase(elements.begin() + index); },
+               m_elements);
+    return true;
+}
+
+void ListTag::swap(size_t indexA, size_t indexB)
+{
+    std::visit([indexA, indexB](auto& elements) { std::swap(elements[indexA], elements[indexB]); },
+               m_elements);
+}
+
 std::unique_ptr<BasicTag> ListTag::takeAt(size_type index)
 {
-    std::unique_ptr<BasicTag> val = std::move(m_value[index]);
-    eraseAt(index);
+    auto& tags                    = this->tags();
+    std::unique_ptr<BasicTag> val = std::move(tags[index]);
+    tags.erase(tags.begin() + index);
     return val;
 }
 
 std::unique_ptr<BasicTag> ListTag::take(BasicTag* tag)
 {
+    auto& tags = this->tags();
+
     std::unique_ptr<BasicTag> val;
     auto it =
-        std::find_if(m_value.begin(), m_value.end(),
+        std::find_if(tags.begin(), tags.end(),
                      [tag](const std::unique_ptr<BasicTag>& ptr) { return ptr.get() == tag; });
-    if(it != m_value.end()) {
+    if(it != tags.end()) {
         val = std::move(*it);
-        m_value.erase(it);
+        tags.erase(it);
     }
     return val;
 }
 
 bool ListTag::erase(BasicTag* tag)
 {
+    auto& tags = this->tags();
     auto it =
-        std::find_if(m_value.begin(), m_value.end(),
+        std::find_if(tags.begin(), tags.end(),
                      [tag](const std::unique_ptr<BasicTag>& ptr) { return ptr.get() == tag; });
-    if(it != m_value.end()) {
-        m_value.erase(it);
+    if(it != tags.end()) {
+        tags.erase(it);
         return true;
     }
     return false;
 }
 
+bool ListTag::isEqual(const BasicTag& other) const
+{
+    const ListTag& otherTag = static_cast<const ListTag&>(other);
+    if(!BasicTag::isEqual(other) || m_listType != otherTag.m_listType
+       || size() != otherTag.size()) {
+        return false;
+    }
+
+    // Packed and unpacked lists with the same values are equal.
+    if(isPacked() && otherTag.isPacked()) {
+        return m_elements == otherTag.m_elements;
+    }
+    if(isPacked()) {
+        return equalElements(std::get<0>(otherTag.m_elements), *this);
+    }
+    if(otherTag.isPacked()) {
+        return equalElements(std::get<0>(m_elements), otherTag);
+    }
+    return std::equal(std::get<0>(m_elements).begin(), std::get<0>(m_elements).end(),
+                      std::get<0>(otherTag.m_elements).begin(),
+                      [](const auto& lhs, const auto& rhs) {
+                          return lhs == rhs || (lhs && rhs && *lhs == *rhs);
+                      });
+}
+
+template<PackableListType T>
+bool ListTag::packAs()
+{
+    const auto& tags = std::get<0>(m_elements);
+
+    ContainerType<T> values;
+    values.reserve(tags.size());
+    for(const auto& tag : tags) {
+        if(!tag || tag->type() != detail::listTypeOf<T>()) {
+            return false;
+        }
+        values.push_back(static_cast<const PackedTag<T>&>(*tag).value());
+    }
+    m_elements = std::move(values);
+    return true;
+}
+
 } // namespace anvil
@@ -0,0 +1,142 @@
+#include "cpp-anvil/nbt/detail/name_table.hpp"
+
+// STL
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace anvil {
+namespace detail {
+
+namespace {
+
+// The keys point into the names, which never move.
+using NameMap = std::unordered_map<std::string_view, InternedName*>;
+
+struct NameTable
+{
+    std::shared_mutex mutex;
+    NameMap names;
+};
+
+NameTable& nameTable()
+{
+    // Never destroyed, tags in static objects may still release their names at exit.
+    static NameTable* table = new NameTable;
+    return *table;
+}
+
+//! @brief Acquires a reference unless the name is already being erased.
+bool tryAcquire(const InternedName* name)
+{
+    size_t references = name->references.load(std::memory_order_relaxed);
+    while(references != 0) {
+        if(name->references.compare_exchange_weak(references, references + 1,
+                                                  std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//! @brief Looks up a name with a shared lock.
+const StringType* internExisting(NameTable& table, std::string_view name)
+{
+    std::shared_lock lock(table.mutex);
+    auto it = table.names.find(name);
+    return it != table.names.end() && tryAcquire(it->second) ? it->second : nullptr;
+}
+
+template<typename Name>
+const StringType* internNew(NameTable& table, Name&& name)
+{
+    auto interned = std::make_unique<InternedName>(std::forward<Name>(name));
+    interned->references.store(1, std::memory_order_relaxed);
+
+    std::unique_lock lock(table.mutex);
+    auto it = table.names.find(*interned);
+    if(it != table.names.end()) {
+        if(tryAcquire(it->second)) {
+            return it->second;
+        }
+        // The last reference was released, the old entry is freed by eraseName().
+        table.names.erase(it);
+    }
+    table.names.emplace(*interned, interned.get());
+    return interned.release();
+}
+
+} // namespace
+
+const StringType* emptyName() noexcept
+{
+    static const InternedName empty;
+    return &empty;
+}
+
+const StringType* internName(std::string_view name)
+{
+    if(name.empty()) {
+        return emptyName();
+    }
+
+    NameTable& table = nameTable();
+    if(const StringType* interned = internExisting(table, name)) {
+        return interned;
+    }
+    return internNew(table, name);
+}
+
+const StringType* internName(StringType&& name)
+{
+    if(name.empty()) {
+        return emptyName();
+    }
+
+    NameTable& table = nameTable();
+    if(const StringType* interned = internExisting(table, name)) {
+        return interned;
+    }
+    return internNew(table, std::move(name));
+}
+
+const StringType* findName(std::string_view name)
+{
+    if(name.empty()) {
+        return emptyName();
+    }
+
+    NameTable& table = nameTable();
+    std::shared_lock lock(table.mutex);
+    auto it = table.names.find(name);
+    if(it == table.names.end() || it->second->references.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void eraseName(const InternedName* name) noexcept
+{
+    NameTable& table = nameTable();
+    {
+        // References are never acquired once the count reached zero, but internName() may have
+        // already replaced the entry by a new one.
+        std::unique_lock lock(table.mutex);
+        auto it = table.names.find(*name);
+        if(it != table.names.end() && it->second == name) {
+            table.names.erase(it);
+        }
+    }
+    delete name;
+}
+
+size_t internedNameCount()
+{
+    NameTable& table = nameTable();
+    std::shared_lock lock(table.mutex);
+    return table.names.size();
+}
+
+} // namespace detail
+} // namespace anvil
@@ -0,0 +1,164 @@
+#include "cpp-anvil/nbt/parser.hpp"
+
+// Internal headers
+#include "util/nbt_byte_stream.hpp"
+
+// STL
+#include <stdexcept>
+
+namespace anvil {
+
+void NbtHandler::beginCompound(std::string_view)
+{ }
+
+void NbtHandler::endCompound()
+{ }
+
+void NbtHandler::beginList(std::string_view, TagType, size_t)
+{ }
+
+void NbtHandler::endList()
+{ }
+
+void NbtHandler::value(std::string_view, ByteType)
+{ }
+
+void NbtHandler::value(std::string_view, ShortType)
+{ }
+
+void NbtHandler::value(std::string_view, IntType)
+{ }
+
+void NbtHandler::value(std::string_view, LongType)
+{ }
+
+void NbtHandler::value(std::string_view, FloatType)
+{ }
+
+void NbtHandler::value(std::string_view, DoubleType)
+{ }
+
+void NbtHandler::value(std::string_view, std::string_view)
+{ }
+
+void NbtHandler::array(std::string_view, std::span<const ByteType>)
+{ }
+
+void NbtHandler::array(std::string_view, std::span<const IntType>)
+{ }
+
+void NbtHandler::array(std::string_view, std::span<const LongType>)
+{ }
+
+namespace {
+
+class NbtParser
+{
+public:
+    NbtParser(const std::vector<unsigned char>& data, NbtHandler& handler)
+        : m_byteStream(data)
+        , m_handler(handler)
+    { }
+
+    void parse()
+    {
+        TagType tagType = m_byteStream.read<TagType>();
+        if(tagType == TagType::Unknown) {
+            throw std::runtime_error("Invalid tag type.");
+        } else if(tagType != TagType::Compound) {
+            throw std::runtime_error("First tag must be of type CompoundTag.");
+        }
+
+        parsePayload(TagType::Compound, m_byteStream.readStringView());
+    }
+
+private:
+    void parsePayload(TagType tagType, std::string_view name)
+    {
+        switch(tagType) {
+            case TagType::Byte:
+                m_handler.value(name, m_byteStream.read<ByteType>());
+                break;
+            case TagType::Short:
+                m_handler.value(name, m_byteStream.read<ShortType>());
+                break;
+            case TagType::Int:
+                m_handler.value(name, m_byteStream.read<IntType>());
+                break;
+            case TagType::Long:
+                m_handler.value(name, m_byteStream.read<LongType>());
+                break;
+            case TagType::Float:
+                m_handler.value(name, m_byteStream.read<FloatType>());
+                break;
+            case TagType::Double:
+                m_handler.value(name, m_byteStream.read<DoubleType>());
+                break;
+            case TagType::ByteArray:
+                m_handler.array(name, m_byteStream.readArray(m_byteBuffer));
+                break;
+            case TagType::String:
+                m_handler.value(name, m_byteStream.readStringView());
+                break;
+            case TagType::List:
+            {
+                const TagType elementType = m_byteStream.read<TagType>();
+                const int32_t size        = m_byteStream.read<int32_t>();
+                if(elementType == TagType::Unknown
+                   || (elementType == TagType::End && size > 0)) {
+                    throw std::runtime_error("Invalid tag type.");
+                }
+
+                m_handler.beginList(name, elementType, size > 0 ? size : 0);
+                for(int32_t i = 0; i < size; ++i) {
+                    parsePayload(elementType, {});
+                }
+                m_handler.endList();
+                break;
+            }
+            case TagType::Compound:
+            {
+                m_handler.beginCompound(name);
+                TagType childType = m_byteStream.read<TagType>();
+                while(childType != TagType::End) {
+                    if(childType == TagType::Unknown) {
+                        throw std::runtime_error("Invalid tag type.");
+                    }
+                    parsePayload(childType, m_byteStream.readStringView());
+                    childType = m_byteStream.read<TagType>();
+                }
+                m_handler.endCompound();
+                break;
+            }
+            case TagType::IntArray:
+                m_handler.array(name, m_byteStream.readArray(m_intBuffer));
+                break;
+            case TagType::LongArray:
+                m_handler.array(name, m_byteStream.readArray(m_longBuffer));
+                break;
+            case TagType::End:
+            case TagType::Unknown:
+            default:
+                throw std::runtime_error("Invalid tag type.");
+        }
+    }
+
+private:
+    NbtInputByteStream m_byteStream;
+    NbtHandler& m_handler;
+
+    // Reused for all arrays of the same type, so arrays only allocate if they are larger than the
+    // previous ones.
+    std::vector<ByteType> m_byteBuffer;
+    std::vector<IntType> m_intBuffer;
+    std::vector<LongType> m_longBuffer;
+};
+
+} // namespace
+
+void parseData(const std::vector<unsigned char>& data, NbtHandler& handler)
+{
+    NbtParser(data, handler).parse();
+}
+
+} // namespace anvil
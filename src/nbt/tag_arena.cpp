@@ -0,0 +1,115 @@
+#include "cpp-anvil/nbt/tag_arena.hpp"
+
+// STL
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace anvil {
+
+namespace {
+
+// Added to the references of a block while the arena allocates from it, so deleting the first
+// tags of a block does not free it.
+constexpr size_t AllocatingBias{size_t(1) << (sizeof(size_t) * 8 - 2)};
+
+// Arena of the innermost scope of the thread
+thread_local TagArena* currentArena{nullptr};
+
+} // namespace
+
+//! @brief Header at the start of every block, blocks are aligned to their size.
+struct TagArena::Block
+{
+    // Number of tags in the block, plus the bias while the arena allocates from it
+    std::atomic<size_t> references{AllocatingBias};
+};
+
+TagArena::Scope::Scope(TagArena& arena)
+    : m_previous(currentArena)
+{
+    currentArena = &arena;
+}
+
+TagArena::Scope::~Scope()
+{
+    currentArena = m_previous;
+}
+
+TagArena::~TagArena()
+{
+    retireBlock();
+}
+
+TagArena* TagArena::current() noexcept
+{
+    return currentArena;
+}
+
+const void* TagArena::blockOf(const BasicTag* tag)
+{
+    return tag != nullptr && tag->isArenaAllocated() ? blockAt(tag) : nullptr;
+}
+
+void* TagArena::allocate(size_t size, size_t alignment)
+{
+    auto align = [alignment](std::byte* ptr) {
+        const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+        return ptr + ((alignment - address % alignment) % alignment);
+    };
+
+    std::byte* position = m_block != nullptr ? align(m_position) : nullptr;
+    if(position == nullptr || static_cast<size_t>(m_end - position) < size) {
+        retireBlock();
+
+        auto* memory = static_cast<std::byte*>(
+            ::operator new(BlockSize, std::align_val_t(BlockSize)));
+        m_block     = new(memory) Block;
+        m_end       = memory + BlockSize;
+        m_reserved += BlockSize;
+        position    = align(memory + sizeof(Block));
+    }
+
+    m_position = position + size;
+    ++m_blockTags;
+    return position;
+}
+
+TagArena::Block* TagArena::blockAt(const void* ptr) noexcept
+{
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr) & ~(BlockSize - 1);
+    return reinterpret_cast<Block*>(address);
+}
+
+void TagArena::freeBlock(Block* block) noexcept
+{
+    block->~Block();
+    ::operator delete(block, std::align_val_t(BlockSize));
+}
+
+void TagArena::deallocate(void* ptr) noexcept
+{
+    Block* block = blockAt(ptr);
+    if(block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        freeBlock(block);
+    }
+}
+
+void TagArena::retireBlock() noexcept
+{
+    if(m_block == nullptr) {
+        return;
+    }
+
+    // Only the tags of the block keep it alive from now on.
+    const size_t unused = AllocatingBias - m_blockTags;
+    if(m_block->references.fetch_sub(unused, std::memory_order_acq_rel) == unused) {
+        freeBlock(m_block);
+    }
+    m_block     = nullptr;
+    m_position  = nullptr;
+    m_end       = nullptr;
+    m_blockTags = 0;
+}
+
+} // namespace anvil
@@ -0,0 +1,126 @@
+#include "cpp-anvil/nbt/collection_tag.hpp"
+#include "cpp-anvil/nbt/compound_tag.hpp"
+#include "cpp-anvil/nbt/list_tag.hpp"
+#include "cpp-anvil/nbt/primitive_tag.hpp"
+#include "cpp-anvil/nbt/tag_arena.hpp"
+
+// Internal headers
+#include "nbt/tag_memory.hpp"
+
+// STL
+#include <algorithm>
+#include <vector>
+
+namespace anvil {
+
+namespace {
+
+size_t heapMemory(const StringType& value)
+{
+    // Short strings are stored within the string object.
+    return (value.capacity() > StringType().capacity()) ? value.capacity() + 1 : 0;
+}
+
+template<typename T>
+size_t heapMemory(const ContainerType<T>& value)
+{
+    return value.capacity() * sizeof(T);
+}
+
+//! @brief Estimates the memory of a tree, counting each arena block once.
+class TreeMemory
+{
+public:
+    size_t estimate(const BasicTag* tag)
+    {
+        // Interned names are shared, every tag counts its name as if it was the only one using it.
+        const StringType& name = tag->name();
+        size_t size            = name.empty() ? 0 : sizeof(detail::InternedName) + heapMemory(name);
+        switch(tag->type()) {
+            case TagType::Byte:
+                return size + objectMemory(tag, sizeof(ByteTag));
+            case TagType::Short:
+                return size + objectMemory(tag, sizeof(ShortTag));
+            case TagType::Int:
+                return size + objectMemory(tag, sizeof(IntTag));
+            case TagType::Long:
+                return size + objectMemory(tag, sizeof(LongTag));
+            case TagType::Float:
+                return size + objectMemory(tag, sizeof(FloatTag));
+            case TagType::Double:
+                return size + objectMemory(tag, sizeof(DoubleTag));
+            case TagType::String:
+                return size + objectMemory(tag, sizeof(StringTag))
+                       + heapMemory(tag->asStringTag()->value());
+            case TagType::ByteArray:
+                return size + objectMemory(tag, sizeof(ByteArrayTag))
+                       + heapMemory(tag->asByteArrayTag()->value());
+            case TagType::IntArray:
+                return size + objectMemory(tag, sizeof(IntArrayTag))
+                       + heapMemory(tag->asIntArrayTag()->value());
+            case TagType::LongArray:
+                return size + objectMemory(tag, sizeof(LongArrayTag))
+                       + heapMemory(tag->asLongArrayTag()->value());
+            case TagType::List:
+            {
+                // Packed lists have no tags, only their values count.
+                const ListTag& listTag = *tag->asListTag();
+                size += objectMemory(tag, sizeof(ListTag));
+                if(listTag.visitValues([&size](auto values) { size += values.size_bytes(); })) {
+                    return size;
+                }
+                return size + childrenMemory(listTag);
+            }
+            case TagType::Compound:
+                return size + objectMemory(tag, sizeof(CompoundTag))
+                       + childrenMemory(*tag->asCompoundTag());
+            default:
+                return size + objectMemory(tag, sizeof(BasicTag));
+        }
+    }
+
+private:
+    template<typename TagT>
+    size_t childrenMemory(const TagT& tag)
+    {
+        size_t size = heapMemory(tag.value());
+        for(const auto& child : tag) {
+            size += estimate(child.get());
+        }
+        return size;
+    }
+
+    //! @brief Returns the size of a heap tag, or the whole block for the first tag of a block.
+    size_t objectMemory(const BasicTag* tag, size_t size)
+    {
+        const void* block = TagArena::blockOf(tag);
+        if(block == nullptr) {
+            return size;
+        }
+        // Tags of a block are mostly visited in a row, a tree only uses few blocks.
+        if(block != m_lastBlock) {
+            m_lastBlock = block;
+            if(std::find(m_blocks.begin(), m_blocks.end(), block) == m_blocks.end()) {
+                m_blocks.push_back(block);
+                return TagArena::BlockSize;
+            }
+        }
+        return 0;
+    }
+
+private:
+    const void* m_lastBlock{nullptr};
+    std::vector<const void*> m_blocks;
+};
+
+} // namespace
+
+size_t estimateTagMemory(const BasicTag* tag)
+{
+    if(tag == nullptr) {
+        return 0;
+    }
+    return TreeMemory().estimate(tag);
+}
+
+} // namespace anvil
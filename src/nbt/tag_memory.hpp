@@ -0,0 +1,22 @@
+#ifndef CPP_ANVIL_NBT_TAG_MEMORY_HPP
+#define CPP_ANVIL_NBT_TAG_MEMORY_HPP
+
+#include <cstddef>
+
+namespace anvil {
+
+class BasicTag;
+
+//! @brief Estimates the memory used by a tag and all of its children.
+//! @details
+//! The estimate includes the tag objects, their heap allocated names, strings and arrays. Tags in
+//! a @ref TagArena count the whole blocks they keep alive instead, each block once per call. The
+//! overhead of the allocator is not included.
+//!
+//! @param tag The tag, may be `nullptr`.
+//! @return Estimated memory in bytes.
+size_t estimateTagMemory(const BasicTag* tag);
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_NBT_TAG_MEMORY_HPP
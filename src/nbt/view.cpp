@@ -0,0 +1,414 @@
+#include "cpp-anvil/nbt/view.hpp"
+
+// Internal headers
+#include "util/byte_swap.hpp"
+
+// STL
+#include <cstring>
+#include <stdexcept>
+
+namespace anvil {
+
+namespace {
+
+void checkAvailable(const unsigned char* data, const unsigned char* end, size_t size)
+{
+    if(data > end || static_cast<size_t>(end - data) < size) {
+        throw std::runtime_error("Unexpected end of NBT data.");
+    }
+}
+
+template<typename T>
+T readValue(const unsigned char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return detail::swapEndian(value);
+}
+
+//! @brief Reads an array or list length, negative lengths are treated as empty.
+size_t readLength(const unsigned char* data, const unsigned char* end)
+{
+    checkAvailable(data, end, sizeof(IntType));
+    const IntType length = readValue<IntType>(data);
+    return length > 0 ? static_cast<size_t>(length) : 0;
+}
+
+//! @brief Returns the size of the payload of a tag with a fixed size, 0 for other tags.
+size_t fixedPayloadSize(TagType type)
+{
+    switch(type) {
+        case TagType::Byte:
+            return sizeof(ByteType);
+        case TagType::Short:
+            return sizeof(ShortType);
+        case TagType::Int:
+            return sizeof(IntType);
+        case TagType::Long:
+            return sizeof(LongType);
+        case TagType::Float:
+            return sizeof(FloatType);
+        case TagType::Double:
+            return sizeof(DoubleType);
+        default:
+            return 0;
+    }
+}
+
+//! @brief Returns the position after the payload of a tag of type @p type starting at @p data.
+const unsigned char* skipPayload(TagType type, const unsigned char* data, const unsigned char* end)
+{
+    if(const size_t size = fixedPayloadSize(type); size > 0) {
+        checkAvailable(data, end, size);
+        return data + size;
+    }
+
+    switch(type) {
+        case TagType::ByteArray:
+        case TagType::IntArray:
+        case TagType::LongArray: {
+            const size_t width  = type == TagType::ByteArray  ? sizeof(ByteType)
+                                  : type == TagType::IntArray ? sizeof(IntType)
+                                                              : sizeof(LongType);
+            const size_t length = readLength(data, end);
+            data += sizeof(IntType);
+            checkAvailable(data, end, length * width);
+            return data + length * width;
+        }
+        case TagType::String: {
+            checkAvailable(data, end, sizeof(uint16_t));
+            const size_t length = readValue<uint16_t>(data);
+            data += sizeof(uint16_t);
+            checkAvailable(data, end, length);
+            return data + length;
+        }
+        case TagType::List: {
+            checkAvailable(data, end, 1);
+            const auto elementType = static_cast<TagType>(*data);
+            const size_t length    = readLength(data + 1, end);
+            data += 1 + sizeof(IntType);
+            if(const size_t size = fixedPayloadSize(elementType); size > 0) {
+                checkAvailable(data, end, length * size);
+                return data + length * size;
+            }
+            for(size_t i = 0; i < length; ++i) {
+                data = skipPayload(elementType, data, end);
+            }
+            return data;
+        }
+        case TagType::Compound: {
+            while(true) {
+                checkAvailable(data, end, 1);
+                const auto childType = static_cast<TagType>(*data);
+                if(childType == TagType::End) {
+                    return data + 1;
+                }
+                data = skipPayload(TagType::String, data + 1, end);
+                data = skipPayload(childType, data, end);
+            }
+        }
+        case TagType::End:
+            // Lists of EndTags have no payload
+            return data;
+        default:
+            throw std::runtime_error("Invalid tag type.");
+    }
+}
+
+} // namespace
+
+NbtView::NbtView(TagType type, const unsigned char* data, const unsigned char* end)
+    : m_type(type)
+    , m_data(data)
+    , m_end(end)
+{ }
+
+TagType NbtView::type() const
+{
+    return m_type;
+}
+
+bool NbtView::isValid() const
+{
+    return m_data != nullptr;
+}
+
+NbtView::operator bool() const
+{
+    return isValid();
+}
+
+const unsigned char* NbtView::payload(TagType type, size_t size) const
+{
+    if(!isValid() || m_type != type) {
+        throw std::runtime_error("Invalid tag type.");
+    }
+    checkAvailable(m_data, m_end, size);
+    return m_data;
+}
+
+ByteType NbtView::asByte() const
+{
+    return readValue<ByteType>(payload(TagType::Byte, sizeof(ByteType)));
+}
+
+ShortType NbtView::asShort() const
+{
+    return readValue<ShortType>(payload(TagType::Short, sizeof(ShortType)));
+}
+
+IntType NbtView::asInt() const
+{
+    return readValue<IntType>(payload(TagType::Int, sizeof(IntType)));
+}
+
+LongType NbtView::asLong() const
+{
+    return readValue<LongType>(payload(TagType::Long, sizeof(LongType)));
+}
+
+FloatType NbtView::asFloat() const
+{
+    return readValue<FloatType>(payload(TagType::Float, sizeof(FloatType)));
+}
+
+DoubleType NbtView::asDouble() const
+{
+    return readValue<DoubleType>(payload(TagType::Double, sizeof(DoubleType)));
+}
+
+std::string_view NbtView::asString() const
+{
+    const unsigned char* data = payload(TagType::String, sizeof(uint16_t));
+    const size_t length       = readValue<uint16_t>(data);
+    checkAvailable(data + sizeof(uint16_t), m_end, length);
+    return {reinterpret_cast<const char*>(data + sizeof(uint16_t)), length};
+}
+
+NbtCompoundView NbtView::asCompound() const
+{
+    return {payload(TagType::Compound, 0), m_end};
+}
+
+NbtListView NbtView::asList() const
+{
+    const unsigned char* data = payload(TagType::List, 1 + sizeof(IntType));
+    return {static_cast<TagType>(data[0]), readLength(data + 1, m_end),
+            data + 1 + sizeof(IntType), m_end};
+}
+
+NbtArrayView<ByteType> NbtView::asByteArray() const
+{
+    const unsigned char* data = payload(TagType::ByteArray, sizeof(IntType));
+    const size_t length       = readLength(data, m_end);
+    checkAvailable(data + sizeof(IntType), m_end, length * sizeof(ByteType));
+    return {data + sizeof(IntType), length};
+}
+
+NbtArrayView<IntType> NbtView::asIntArray() const
+{
+    const unsigned char* data = payload(TagType::IntArray, sizeof(IntType));
+    const size_t length       = readLength(data, m_end);
+    checkAvailable(data + sizeof(IntType), m_end, length * sizeof(IntType));
+    return {data + sizeof(IntType), length};
+}
+
+NbtArrayView<LongType> NbtView::asLongArray() const
+{
+    const unsigned char* data = payload(TagType::LongArray, sizeof(IntType));
+    const size_t length       = readLength(data, m_end);
+    checkAvailable(data + sizeof(IntType), m_end, length * sizeof(LongType));
+    return {data + sizeof(IntType), length};
+}
+
+NbtCompoundView::Iterator::Iterator(const unsigned char* position, const unsigned char* end)
+    : m_position(position)
+    , m_end(end)
+{
+    readEntry();
+}
+
+void NbtCompoundView::Iterator::readEntry()
+{
+    checkAvailable(m_position, m_end, 1);
+    const auto type = static_cast<TagType>(*m_position);
+    if(type == TagType::End) {
+        m_position = nullptr;
+        m_entry    = {};
+        return;
+    }
+
+    const unsigned char* name = m_position + 1;
+    const unsigned char* data = skipPayload(TagType::String, name, m_end);
+    m_entry.name  = {reinterpret_cast<const char*>(name + sizeof(uint16_t)),
+                     static_cast<size_t>(data - name) - sizeof(uint16_t)};
+    m_entry.value = NbtView(type, data, m_end);
+}
+
+NbtCompoundView::Iterator& NbtCompoundView::Iterator::operator++()
+{
+    m_position = skipPayload(m_entry.value.type(), m_entry.value.m_data, m_end);
+    readEntry();
+    return *this;
+}
+
+NbtCompoundView::Iterator NbtCompoundView::Iterator::operator++(int)
+{
+    Iterator it = *this;
+    ++*this;
+    return it;
+}
+
+NbtCompoundView::NbtCompoundView(const unsigned char* data, const unsigned char* end)
+    : m_data(data)
+    , m_end(end)
+{ }
+
+NbtCompoundView::Iterator NbtCompoundView::begin() const
+{
+    if(m_data == nullptr) {
+        return {};
+    }
+    return {m_data, m_end};
+}
+
+NbtCompoundView::Iterator NbtCompoundView::end() const
+{
+    return {};
+}
+
+NbtView NbtCompoundView::find(std::string_view name) const
+{
+    for(const Entry& entry : *this) {
+        if(entry.name == name) {
+            return entry.value;
+        }
+    }
+    return {};
+}
+
+NbtView NbtCompoundView::operator[](std::string_view name) const
+{
+    return find(name);
+}
+
+bool NbtCompoundView::contains(std::string_view name) const
+{
+    return find(name).isValid();
+}
+
+size_t NbtCompoundView::size() const
+{
+    size_t count = 0;
+    for(auto it = begin(); it != end(); ++it) {
+        ++count;
+    }
+    return count;
+}
+
+NbtListView::Iterator::Iterator(TagType type, const unsigned char* position,
+                                const unsigned char* end, size_t remaining)
+    : m_value(type, position, end)
+    , m_end(end)
+    , m_remaining(remaining)
+{ }
+
+NbtListView::Iterator& NbtListView::Iterator::operator++()
+{
+    if(--m_remaining > 0) {
+        m_value.m_data = skipPayload(m_value.type(), m_value.m_data, m_end);
+    }
+    return *this;
+}
+
+NbtListView::Iterator NbtListView::Iterator::operator++(int)
+{
+    Iterator it = *this;
+    ++*this;
+    return it;
+}
+
+NbtListView::NbtListView(TagType elementType, size_t size, const unsigned char* data,
+                         const unsigned char* end)
+    : m_elementType(elementType)
+    , m_size(size)
+    , m_data(data)
+    , m_end(end)
+{ }
+
+NbtListView::Iterator NbtListView::begin() const
+{
+    if(m_size == 0) {
+        return end();
+    }
+    return {m_elementType, m_data, m_end, m_size};
+}
+
+NbtListView::Iterator NbtListView::end() const
+{
+    return {};
+}
+
+TagType NbtListView::elementType() const
+{
+    return m_elementType;
+}
+
+size_t NbtListView::size() const
+{
+    return m_size;
+}
+
+bool NbtListView::empty() const
+{
+    return m_size == 0;
+}
+
+NbtView NbtListView::operator[](size_t index) const
+{
+    if(index >= m_size) {
+        throw std::out_of_range("Index out of range.");
+    }
+
+    if(const size_t size = fixedPayloadSize(m_elementType); size > 0) {
+        return {m_elementType, m_data + index * size, m_end};
+    }
+
+    const unsigned char* data = m_data;
+    for(size_t i = 0; i < index; ++i) {
+        data = skipPayload(m_elementType, data, m_end);
+    }
+    return {m_elementType, data, m_end};
+}
+
+template<typename T>
+T NbtArrayView<T>::operator[](size_t index) const
+{
+    return readValue<T>(m_data + index * sizeof(T));
+}
+
+template<typename T>
+T NbtArrayView<T>::at(size_t index) const
+{
+    if(index >= m_size) {
+        throw std::out_of_range("Index out of range.");
+    }
+    return (*this)[index];
+}
+
+template class NbtArrayView<ByteType>;
+template class NbtArrayView<IntType>;
+template class NbtArrayView<LongType>;
+
+NbtView viewData(std::span<const unsigned char> data)
+{
+    if(data.empty() || data[0] != static_cast<unsigned char>(TagType::Compound)) {
+        throw std::runtime_error("First tag must be of type CompoundTag.");
+    }
+
+    const unsigned char* end     = data.data() + data.size();
+    const unsigned char* payload = skipPayload(TagType::String, data.data() + 1, end);
+    return {TagType::Compound, payload, end};
+}
+
+} // namespace anvil
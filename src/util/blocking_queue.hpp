@@ -0,0 +1,91 @@
+#ifndef CPP_ANVIL_UTIL_BLOCKING_QUEUE_HPP
+#define CPP_ANVIL_UTIL_BLOCKING_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace anvil {
+namespace detail {
+
+//! @brief Thread-safe FIFO queue with optional capacity limit.
+//! @details
+//! Producers block while the queue is full, consumers block while it is empty. After
+//! @ref close() no further values are accepted and consumers drain the remaining values.
+template<typename T>
+class BlockingQueue
+{
+public:
+    //! @brief Creates a queue.
+    //! @param capacity Maximum number of queued values. `0` does not limit the queue.
+    explicit BlockingQueue(size_t capacity = 0)
+        : m_capacity(capacity)
+    { }
+
+    //! @brief Appends @p value, waits while the queue is full.
+    //! @return `false` if the queue has been closed, the value is dropped then.
+    bool push(T value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() {
+            return m_closed || m_capacity == 0 || m_values.size() < m_capacity;
+        });
+        if(m_closed) {
+            return false;
+        }
+        m_values.push_back(std::move(value));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    //! @brief Takes the first value, waits while the queue is empty.
+    //! @return `false` if the queue has been closed and is empty.
+    bool pop(T& value)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return m_closed || !m_values.empty(); });
+        return takeFront(value);
+    }
+
+    //! @brief Takes the first value without waiting.
+    //! @return `false` if the queue is empty.
+    bool tryPop(T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return takeFront(value);
+    }
+
+    //! @brief Closes the queue and wakes up all waiting threads.
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notEmpty.notify_all();
+        m_notFull.notify_all();
+    }
+
+private:
+    bool takeFront(T& value)
+    {
+        if(m_values.empty()) {
+            return false;
+        }
+        value = std::move(m_values.front());
+        m_values.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    const size_t m_capacity;
+    bool m_closed{false};
+    std::deque<T> m_values;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+} // namespace detail
+} // namespace anvil
+
+#endif // CPP_ANVIL_UTIL_BLOCKING_QUEUE_HPP
@@ -0,0 +1,217 @@
+// Internal headers
+#include "util/byte_swap.hpp"
+
+// STL
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPPANVIL_BYTE_SWAP_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define CPPANVIL_BYTE_SWAP_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(CPPANVIL_BYTE_SWAP_X86) && !defined(_MSC_VER)
+#define CPPANVIL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CPPANVIL_TARGET(isa)
+#endif
+
+namespace anvil {
+namespace detail {
+
+namespace {
+
+using CopySwappedFunction = void (*)(void*, const void*, size_t) noexcept;
+
+struct CopySwappedFunctions
+{
+    CopySwappedFunction copy16;
+    CopySwappedFunction copy32;
+    CopySwappedFunction copy64;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar
+
+template<typename T>
+void copySwappedScalar(void* dst, const void* src, size_t count) noexcept
+{
+    auto* out      = static_cast<unsigned char*>(dst);
+    const auto* in = static_cast<const unsigned char*>(src);
+    for(size_t i = 0; i < count; ++i) {
+        T value;
+        std::memcpy(&value, in + i * sizeof(T), sizeof(T));
+        value = bswap(value);
+        std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+    }
+}
+
+#if defined(CPPANVIL_BYTE_SWAP_X86)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SSSE3 and AVX2, both shuffle the bytes of every 128 bit lane with the same mask
+
+template<typename T>
+constexpr char shuffleIndex(int i)
+{
+    return static_cast<char>(i - i % sizeof(T) + (sizeof(T) - 1 - i % sizeof(T)));
+}
+
+template<typename T>
+CPPANVIL_TARGET("ssse3")
+void copySwappedSsse3(void* dst, const void* src, size_t count) noexcept
+{
+    const __m128i mask =
+        _mm_setr_epi8(shuffleIndex<T>(0), shuffleIndex<T>(1), shuffleIndex<T>(2),
+                      shuffleIndex<T>(3), shuffleIndex<T>(4), shuffleIndex<T>(5),
+                      shuffleIndex<T>(6), shuffleIndex<T>(7), shuffleIndex<T>(8),
+                      shuffleIndex<T>(9), shuffleIndex<T>(10), shuffleIndex<T>(11),
+                      shuffleIndex<T>(12), shuffleIndex<T>(13), shuffleIndex<T>(14),
+                      shuffleIndex<T>(15));
+
+    auto* out                = static_cast<unsigned char*>(dst);
+    const auto* in           = static_cast<const unsigned char*>(src);
+    const size_t bytes       = count * sizeof(T);
+    const size_t vectorBytes = bytes - bytes % sizeof(__m128i);
+    for(size_t i = 0; i < vectorBytes; i += sizeof(__m128i)) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(value, mask));
+    }
+    copySwappedScalar<T>(out + vectorBytes, in + vectorBytes, (bytes - vectorBytes) / sizeof(T));
+}
+
+template<typename T>
+CPPANVIL_TARGET("avx2")
+void copySwappedAvx2(void* dst, const void* src, size_t count) noexcept
+{
+    const __m256i mask = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        shuffleIndex<T>(0), shuffleIndex<T>(1), shuffleIndex<T>(2), shuffleIndex<T>(3),
+        shuffleIndex<T>(4), shuffleIndex<T>(5), shuffleIndex<T>(6), shuffleIndex<T>(7),
+        shuffleIndex<T>(8), shuffleIndex<T>(9), shuffleIndex<T>(10), shuffleIndex<T>(11),
+        shuffleIndex<T>(12), shuffleIndex<T>(13), shuffleIndex<T>(14), shuffleIndex<T>(15)));
+
+    auto* out                = static_cast<unsigned char*>(dst);
+    const auto* in           = static_cast<const unsigned char*>(src);
+    const size_t bytes       = count * sizeof(T);
+    const size_t vectorBytes = bytes - bytes % sizeof(__m256i);
+    for(size_t i = 0; i < vectorBytes; i += sizeof(__m256i)) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(value, mask));
+    }
+    copySwappedScalar<T>(out + vectorBytes, in + vectorBytes, (bytes - vectorBytes) / sizeof(T));
+}
+
+bool cpuSupports(bool avx2)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    if(avx2) {
+        if(maxLeaf < 7) {
+            return false;
+        }
+        // The OS has to save the AVX registers as well.
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        if(!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+#endif
+}
+
+CopySwappedFunctions selectFunctions()
+{
+    if(cpuSupports(true)) {
+        return {copySwappedAvx2<uint16_t>, copySwappedAvx2<uint32_t>, copySwappedAvx2<uint64_t>};
+    }
+    if(cpuSupports(false)) {
+        return {copySwappedSsse3<uint16_t>, copySwappedSsse3<uint32_t>,
+                copySwappedSsse3<uint64_t>};
+    }
+    return {copySwappedScalar<uint16_t>, copySwappedScalar<uint32_t>,
+            copySwappedScalar<uint64_t>};
+}
+
+#elif defined(CPPANVIL_BYTE_SWAP_NEON)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// NEON, always available on AArch64
+
+template<typename T>
+void copySwappedNeon(void* dst, const void* src, size_t count) noexcept
+{
+    auto* out                = static_cast<unsigned char*>(dst);
+    const auto* in           = static_cast<const unsigned char*>(src);
+    const size_t bytes       = count * sizeof(T);
+    const size_t vectorBytes = bytes - bytes % sizeof(uint8x16_t);
+    for(size_t i = 0; i < vectorBytes; i += sizeof(uint8x16_t)) {
+        const uint8x16_t value = vld1q_u8(in + i);
+        if constexpr(sizeof(T) == 2) {
+            vst1q_u8(out + i, vrev16q_u8(value));
+        } else if constexpr(sizeof(T) == 4) {
+            vst1q_u8(out + i, vrev32q_u8(value));
+        } else {
+            vst1q_u8(out + i, vrev64q_u8(value));
+        }
+    }
+    copySwappedScalar<T>(out + vectorBytes, in + vectorBytes, (bytes - vectorBytes) / sizeof(T));
+}
+
+CopySwappedFunctions selectFunctions()
+{
+    return {copySwappedNeon<uint16_t>, copySwappedNeon<uint32_t>, copySwappedNeon<uint64_t>};
+}
+
+#else
+
+CopySwappedFunctions selectFunctions()
+{
+    return {copySwappedScalar<uint16_t>, copySwappedScalar<uint32_t>,
+            copySwappedScalar<uint64_t>};
+}
+
+#endif
+
+const CopySwappedFunctions& functions()
+{
+    // Selected once, the CPU does not change while the program runs.
+    static const CopySwappedFunctions selected = selectFunctions();
+    return selected;
+}
+
+} // namespace
+
+void copySwapped(void* dst, const void* src, size_t count, size_t width) noexcept
+{
+    switch(width) {
+        case 1:
+            std::memcpy(dst, src, count);
+            break;
+        case 2:
+            functions().copy16(dst, src, count);
+            break;
+        case 4:
+            functions().copy32(dst, src, count);
+            break;
+        case 8:
+            functions().copy64(dst, src, count);
+            break;
+    }
+}
+
+} // namespace detail
+} // namespace anvil
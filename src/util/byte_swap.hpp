@@ -3,7 +3,9 @@
 
 #include <bit>
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 namespace anvil {
 namespace detail {
@@ -77,6 +79,29 @@ T swapEndian(T value)
     }
 }
 
+//! @brief Copies @p count values of @p width bytes and reverses the byte order of every value.
+//! @details
+//! Uses SSSE3, AVX2 or NEON if the CPU supports it, the implementation is selected at runtime.
+//! @param dst Destination, must not overlap @p src.
+//! @param src Source.
+//! @param count Number of values.
+//! @param width Size of the values in bytes, one of 1, 2, 4 and 8.
+void copySwapped(void* dst, const void* src, std::size_t count, std::size_t width) noexcept;
+
+//! @brief Copies @p count big endian values from @p src to @p dst in native byte order.
+//! @param dst Destination.
+//! @param src Source, does not need to be aligned.
+//! @param count Number of values.
+template<typename T>
+void copyFromBigEndian(T* dst, const unsigned char* src, std::size_t count) noexcept
+{
+    if constexpr(sizeof(T) == 1 || std::endian::native == std::endian::big) {
+        std::memcpy(dst, src, count * sizeof(T));
+    } else {
+        copySwapped(dst, src, count, sizeof(T));
+    }
+}
+
 } // namespace detail
 } // namespace anvil
 
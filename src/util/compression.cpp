@@ -1,18 +1,656 @@
 #include "cpp-anvil/util/compression.hpp"
 
+// Internal headers
+#include "util/parallel.hpp"
+
 #include <zlib.h>
+#if defined(CPPANVIL_HAS_LZ4)
+#include <lz4.h>
+#endif
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+#include <libdeflate.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
 
 namespace anvil {
 
 constexpr size_t GzipChunkSize = 32768;
 constexpr size_t ZlibChunkSize = 16384;
 
+namespace {
+
+uint32_t readLittleEndian32(const unsigned char* data)
+{
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8)
+         | (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+void writeLittleEndian32(unsigned char* data, uint32_t value)
+{
+    data[0] = static_cast<unsigned char>(value);
+    data[1] = static_cast<unsigned char>(value >> 8);
+    data[2] = static_cast<unsigned char>(value >> 16);
+    data[3] = static_cast<unsigned char>(value >> 24);
+}
+
+#if defined(CPPANVIL_HAS_LZ4)
+
+// Block stream format of lz4-java, which is used by minecraft for LZ4 compressed chunks.
+constexpr unsigned char Lz4BlockMagic[]    = {'L', 'Z', '4', 'B', 'l', 'o', 'c', 'k'};
+constexpr size_t Lz4BlockHeaderSize        = 21;
+constexpr size_t Lz4BlockSize              = 65536;
+constexpr unsigned char Lz4MethodRaw       = 0x10;
+constexpr unsigned char Lz4MethodLz4       = 0x20;
+constexpr unsigned char Lz4CompressionBase = 10;
+constexpr uint32_t Lz4ChecksumSeed         = 0x9747B28C;
+constexpr uint32_t Lz4ChecksumMask         = 0x0FFFFFFF;
+
+uint32_t rotateLeft32(uint32_t value, int bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// XXH32 hash, lz4-java checks every block with it.
+uint32_t xxh32(const unsigned char* data, size_t size, uint32_t seed)
+{
+    constexpr uint32_t Prime1 = 2654435761u;
+    constexpr uint32_t Prime2 = 2246822519u;
+    constexpr uint32_t Prime3 = 3266489917u;
+    constexpr uint32_t Prime4 = 668265263u;
+    constexpr uint32_t Prime5 = 374761393u;
+
+    const unsigned char* end = data + size;
+    uint32_t hash;
+    if(size >= 16) {
+        uint32_t v1 = seed + Prime1 + Prime2;
+        uint32_t v2 = seed + Prime2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - Prime1;
+        for(; end - data >= 16; data += 16) {
+            v1 = rotateLeft32(v1 + readLittleEndian32(data) * Prime2, 13) * Prime1;
+            v2 = rotateLeft32(v2 + readLittleEndian32(data + 4) * Prime2, 13) * Prime1;
+            v3 = rotateLeft32(v3 + readLittleEndian32(data + 8) * Prime2, 13) * Prime1;
+            v4 = rotateLeft32(v4 + readLittleEndian32(data + 12) * Prime2, 13) * Prime1;
+        }
+        hash = rotateLeft32(v1, 1) + rotateLeft32(v2, 7) + rotateLeft32(v3, 12)
+             + rotateLeft32(v4, 18);
+    } else {
+        hash = seed + Prime5;
+    }
+    hash += static_cast<uint32_t>(size);
+
+    for(; end - data >= 4; data += 4) {
+        hash = rotateLeft32(hash + readLittleEndian32(data) * Prime3, 17) * Prime4;
+    }
+    for(; data < end; ++data) {
+        hash = rotateLeft32(hash + *data * Prime5, 11) * Prime1;
+    }
+
+    hash ^= hash >> 15;
+    hash *= Prime2;
+    hash ^= hash >> 13;
+    hash *= Prime3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+void writeLz4BlockHeader(unsigned char* header, unsigned char method, uint32_t compressedSize,
+                         uint32_t size, uint32_t checksum)
+{
+    // The compression level encodes the block size, 64 KiB = 1 << (6 + 10).
+    std::memcpy(header, Lz4BlockMagic, sizeof(Lz4BlockMagic));
+    header[8] = method | 6;
+    writeLittleEndian32(header + 9, compressedSize);
+    writeLittleEndian32(header + 13, size);
+    writeLittleEndian32(header + 17, checksum);
+}
+
+#endif
+
+// The gzip trailer stores the uncompressed size modulo 2^32, which is exact for a single member
+// smaller than 4 GiB. Deflate does not compress better than 1032:1, larger values are ignored.
+constexpr size_t MaxDeflateRatio = 1032;
+
+size_t gzipUncompressedSize(std::span<const unsigned char> in)
+{
+    if(in.size() < 18) {
+        return 0;
+    }
+    const size_t size = readLittleEndian32(in.data() + in.size() - 4);
+    return size <= in.size() * MaxDeflateRatio ? size : 0;
+}
+
+#if !defined(CPPANVIL_HAS_LIBDEFLATE)
+size_t gzipUncompressedSize(std::ifstream& strm)
+{
+    const std::streampos start = strm.tellg();
+    if(start == std::streampos(-1) || !strm.seekg(0, std::ios::end)) {
+        strm.clear();
+        strm.seekg(start);
+        return 0;
+    }
+
+    const std::streamoff length = strm.tellg() - start;
+    unsigned char trailer[4]{};
+    size_t size = 0;
+    if(length >= 18 && strm.seekg(-4, std::ios::end)
+       && strm.read(reinterpret_cast<char*>(trailer), sizeof(trailer))) {
+        size = readLittleEndian32(trailer);
+        if(size > static_cast<size_t>(length) * MaxDeflateRatio) {
+            size = 0;
+        }
+    }
+    strm.clear();
+    strm.seekg(start);
+    return size;
+}
+#endif
+
+// Blocks compressed in parallel, each primed with the deflate window of its predecessor.
+constexpr size_t ParallelBlockSize = 131072;
+constexpr size_t DeflateWindowSize = 32768;
+
+using ChecksumFunction = uLong (*)(uLong, const unsigned char*, size_t);
+using CombineFunction  = uLong (*)(uLong, uLong, size_t);
+
+// Compresses `in` into a raw deflate stream with blocks compressed in parallel, like pigz. Each
+// block ends with a sync flush on a byte boundary and the last one finishes the stream, so the
+// blocks can be concatenated. The checksum of the data is computed per block and combined.
+bool deflateParallel(std::span<const unsigned char> in, std::vector<unsigned char>& out,
+                     int compressionLevel, size_t threadCount, ChecksumFunction checksum,
+                     CombineFunction combine, uLong& check)
+{
+    const size_t blockCount = (in.size() + ParallelBlockSize - 1) / ParallelBlockSize;
+    std::vector<std::vector<unsigned char>> blocks(blockCount);
+    std::vector<uLong> checks(blockCount);
+    std::vector<char> success(blockCount, 0);
+
+    detail::parallelFor(blockCount, threadCount, [&](size_t i) {
+        const size_t offset                = i * ParallelBlockSize;
+        const size_t size                  = std::min(ParallelBlockSize, in.size() - offset);
+        const bool last                    = i + 1 == blockCount;
+        std::vector<unsigned char>& target = blocks[i];
+
+        checks[i] = checksum(checksum(0, nullptr, 0), in.data() + offset, size);
+
+        z_stream zstrm{};
+        if(deflateInit2(&zstrm, compressionLevel, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)
+           != Z_OK) {
+            return;
+        }
+        if(i > 0) {
+            const size_t dictionary = std::min(DeflateWindowSize, offset);
+            deflateSetDictionary(&zstrm, in.data() + offset - dictionary,
+                                 static_cast<uInt>(dictionary));
+        }
+
+        zstrm.next_in  = const_cast<Bytef*>(in.data() + offset);
+        zstrm.avail_in = static_cast<uInt>(size);
+        target.resize(deflateBound(&zstrm, static_cast<uLong>(size)) + 16);
+
+        int ret{0};
+        do {
+            if(zstrm.total_out == target.size()) {
+                target.resize(target.size() * 2);
+            }
+            zstrm.next_out  = target.data() + zstrm.total_out;
+            zstrm.avail_out = static_cast<uInt>(target.size() - zstrm.total_out);
+            ret             = deflate(&zstrm, last ? Z_FINISH : Z_SYNC_FLUSH);
+        } while(ret == Z_OK && zstrm.avail_out == 0);
+
+        target.resize(zstrm.total_out);
+        success[i] = last ? ret == Z_STREAM_END : ret == Z_OK;
+        deflateEnd(&zstrm);
+    });
+
+    if(std::find(success.begin(), success.end(), 0) != success.end()) {
+        return false;
+    }
+
+    check = checksum(0, nullptr, 0);
+    for(size_t i = 0; i < blockCount; ++i) {
+        const size_t size = std::min(ParallelBlockSize, in.size() - i * ParallelBlockSize);
+        check             = combine(check, checks[i], size);
+        out.insert(out.end(), blocks[i].begin(), blocks[i].end());
+    }
+    return true;
+}
+
+// Number of times a buffer of size `initial` is doubled until `size` bytes fit.
+size_t growthsFor(size_t initial, size_t size)
+{
+    size_t growths = 0;
+    for(; initial < size; initial *= 2) {
+        ++growths;
+    }
+    return growths;
+}
+
+std::span<const unsigned char> asUnsignedChars(std::span<const std::byte> data)
+{
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
+bool deflateLz4(std::span<const unsigned char> in, std::vector<unsigned char>& out)
+{
+    out.clear();
+
+    // Just check that there is actually data
+    if(in.empty()) {
+        return true;
+    }
+
+#if defined(CPPANVIL_HAS_LZ4)
+    for(size_t pos = 0; pos < in.size(); pos += Lz4BlockSize) {
+        const size_t size     = std::min(Lz4BlockSize, in.size() - pos);
+        const int bound       = LZ4_compressBound(static_cast<int>(size));
+        const size_t offset   = out.size();
+        const uint32_t check  = xxh32(in.data() + pos, size, Lz4ChecksumSeed) & Lz4ChecksumMask;
+        unsigned char* target = nullptr;
+
+        out.resize(offset + Lz4BlockHeaderSize + static_cast<size_t>(bound));
+        target = out.data() + offset + Lz4BlockHeaderSize;
+
+        int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(in.data() + pos),
+                                                  reinterpret_cast<char*>(target),
+                                                  static_cast<int>(size), bound);
+        unsigned char method = Lz4MethodLz4;
+        if(compressedSize <= 0 || static_cast<size_t>(compressedSize) >= size) {
+            // Incompressible data is stored as it is.
+            std::memcpy(target, in.data() + pos, size);
+            compressedSize = static_cast<int>(size);
+            method         = Lz4MethodRaw;
+        }
+
+        writeLz4BlockHeader(out.data() + offset, method, static_cast<uint32_t>(compressedSize),
+                            static_cast<uint32_t>(size), check);
+        out.resize(offset + Lz4BlockHeaderSize + static_cast<size_t>(compressedSize));
+    }
+
+    // End of stream
+    const size_t offset = out.size();
+    out.resize(offset + Lz4BlockHeaderSize);
+    writeLz4BlockHeader(out.data() + offset, Lz4MethodRaw, 0, 0, 0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+
+struct LibdeflateDeleter
+{
+    void operator()(libdeflate_compressor* compressor) const
+    {
+        libdeflate_free_compressor(compressor);
+    }
+
+    void operator()(libdeflate_decompressor* decompressor) const
+    {
+        libdeflate_free_decompressor(decompressor);
+    }
+};
+
+bool readRemaining(std::ifstream& strm, std::vector<unsigned char>& data)
+{
+    data.assign(std::istreambuf_iterator<char>(strm), std::istreambuf_iterator<char>());
+    return !strm.bad();
+}
+
+bool writeAll(std::ofstream& strm, const std::vector<unsigned char>& data)
+{
+    strm.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    return strm.good();
+}
+
+#endif
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Inflater
+
+class Inflater::Impl
+{
+public:
+    ~Impl()
+    {
+#if !defined(CPPANVIL_HAS_LIBDEFLATE)
+        if(initialized) {
+            inflateEnd(&zstrm);
+        }
+#endif
+    }
+
+    bool inflate(CompressionType compression, std::span<const unsigned char> in,
+                 std::vector<unsigned char>& out, size_t& growths);
+
+    InflateStats stats;
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::unique_ptr<libdeflate_decompressor, LibdeflateDeleter> decompressor;
+#else
+    z_stream zstrm{};
+    bool initialized{false};
+#endif
+};
+
+bool Inflater::Impl::inflate(CompressionType compression, std::span<const unsigned char> in,
+                             std::vector<unsigned char>& out, size_t& growths)
+{
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    if(!decompressor) {
+        decompressor.reset(libdeflate_alloc_decompressor());
+        if(!decompressor) {
+            return false;
+        }
+    }
+
+    auto decompress = compression == CompressionType::Gzip ? libdeflate_gzip_decompress
+                                                           : libdeflate_zlib_decompress;
+    while(true) {
+        size_t size = 0;
+        const libdeflate_result ret = decompress(decompressor.get(), in.data(), in.size(),
+                                                 out.data(), out.size(), &size);
+        if(ret == LIBDEFLATE_SUCCESS) {
+            out.resize(size);
+            return true;
+        }
+        if(ret != LIBDEFLATE_INSUFFICIENT_SPACE) {
+            return false;
+        }
+        out.resize(out.size() * 2);
+        ++growths;
+    }
+#else
+    // The stream is reset instead of initialized again, which keeps the allocated window.
+    const int windowBits = compression == CompressionType::Gzip ? 16 + MAX_WBITS : MAX_WBITS;
+    if(!initialized) {
+        if(inflateInit2(&zstrm, windowBits) != Z_OK) {
+            return false;
+        }
+        initialized = true;
+    } else if(inflateReset2(&zstrm, windowBits) != Z_OK) {
+        return false;
+    }
+
+    zstrm.next_in  = const_cast<Bytef*>(in.data());
+    zstrm.avail_in = static_cast<uInt>(in.size());
+
+    int ret{0};
+    do {
+        if(zstrm.total_out == out.size()) {
+            out.resize(out.size() * 2);
+            ++growths;
+        }
+        zstrm.next_out  = out.data() + zstrm.total_out;
+        zstrm.avail_out = static_cast<uInt>(out.size() - zstrm.total_out);
+
+        ret = ::inflate(&zstrm, Z_NO_FLUSH);
+        if(ret != Z_OK && ret != Z_STREAM_END) {
+            return false;
+        }
+
+        // Without any input left, the data is truncated.
+        if(ret == Z_OK && zstrm.avail_in == 0 && zstrm.avail_out != 0) {
+            return false;
+        }
+    } while(ret != Z_STREAM_END);
+
+    out.resize(zstrm.total_out);
+    return true;
+#endif
+}
+
+Inflater::Inflater()
+    : m_impl(std::make_unique<Impl>())
+{ }
+
+Inflater::~Inflater() = default;
+
+Inflater::Inflater(Inflater&&) noexcept = default;
+
+Inflater& Inflater::operator=(Inflater&&) noexcept = default;
+
+Inflater& Inflater::threadLocal()
+{
+    thread_local Inflater inflater;
+    return inflater;
+}
+
+const InflateStats& Inflater::stats() const
+{
+    return m_impl->stats;
+}
+
+void Inflater::resetStats()
+{
+    m_impl->stats = InflateStats{};
+}
+
+bool Inflater::inflate(CompressionType compression, std::span<const std::byte> in,
+                       std::vector<unsigned char>& out, size_t sizeHint)
+{
+    return inflate(compression, asUnsignedChars(in), out, sizeHint);
+}
+
+bool Inflater::inflate(CompressionType compression, std::span<const unsigned char> in,
+                       std::vector<unsigned char>& out, size_t sizeHint)
+{
+    switch(compression) {
+        case CompressionType::Gzip:
+        case CompressionType::Zlib:
+            break;
+        case CompressionType::Uncompressed:
+            out.assign(in.begin(), in.end());
+            return true;
+        case CompressionType::Lz4:
+            out.reserve(sizeHint);
+            return inflate_lz4(in, out);
+        default:
+            return false;
+    }
+
+    // Just check that there is actually data
+    out.clear();
+    if(in.empty()) {
+        return true;
+    }
+
+    if(sizeHint == 0 && compression == CompressionType::Gzip) {
+        sizeHint = gzipUncompressedSize(in);
+    }
+
+    // Start with the hint or a guess for output size, the buffer grows if the data does not fit.
+    const size_t guess = std::max<size_t>(in.size() * 4, 4096);
+    out.resize(sizeHint != 0 ? sizeHint : guess);
+
+    size_t growths = 0;
+    if(!m_impl->inflate(compression, in, out, growths)) {
+        return false;
+    }
+
+    InflateStats& stats = m_impl->stats;
+    ++stats.buffers;
+    stats.reallocations += growths;
+    if(sizeHint != 0) {
+        const size_t guessedGrowths = growthsFor(guess, out.size());
+        ++stats.hintedBuffers;
+        stats.exactHints += sizeHint == out.size() ? 1 : 0;
+        stats.avoidedReallocations += guessedGrowths > growths ? guessedGrowths - growths : 0;
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Deflater
+
+class Deflater::Impl
+{
+public:
+    ~Impl()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+        compressor.reset();
+#else
+        if(gzipInitialized) {
+            deflateEnd(&gzip);
+            gzipInitialized = false;
+        }
+        if(zlibInitialized) {
+            deflateEnd(&zlib);
+            zlibInitialized = false;
+        }
+#endif
+    }
+
+    int compressionLevel{DefaultCompression};
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::unique_ptr<libdeflate_compressor, LibdeflateDeleter> compressor;
+#else
+    z_stream gzip{};
+    z_stream zlib{};
+    bool gzipInitialized{false};
+    bool zlibInitialized{false};
+#endif
+};
+
+Deflater::Deflater(int compressionLevel)
+    : m_impl(std::make_unique<Impl>())
+{
+    m_impl->compressionLevel = compressionLevel;
+}
+
+Deflater::~Deflater() = default;
+
+Deflater::Deflater(Deflater&&) noexcept = default;
+
+Deflater& Deflater::operator=(Deflater&&) noexcept = default;
+
+Deflater& Deflater::threadLocal()
+{
+    thread_local Deflater deflater;
+    return deflater;
+}
+
+int Deflater::compressionLevel() const
+{
+    return m_impl->compressionLevel;
+}
+
+void Deflater::setCompressionLevel(int compressionLevel)
+{
+    if(compressionLevel != m_impl->compressionLevel) {
+        m_impl->reset();
+        m_impl->compressionLevel = compressionLevel;
+    }
+}
+
+bool Deflater::deflate(CompressionType compression, std::span<const std::byte> in,
+                       std::vector<unsigned char>& out)
+{
+    return deflate(compression, asUnsignedChars(in), out);
+}
+
+bool Deflater::deflate(CompressionType compression, std::span<const unsigned char> in,
+                       std::vector<unsigned char>& out)
+{
+    switch(compression) {
+        case CompressionType::Gzip:
+        case CompressionType::Zlib:
+            break;
+        case CompressionType::Uncompressed:
+            out.assign(in.begin(), in.end());
+            return true;
+        case CompressionType::Lz4:
+            return deflateLz4(in, out);
+        default:
+            return false;
+    }
+
+    // Just check that there is actually data
+    out.clear();
+    if(in.empty()) {
+        return true;
+    }
+
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    if(!m_impl->compressor) {
+        // zlib levels map to the same libdeflate levels, zlib uses 6 by default.
+        const int level = m_impl->compressionLevel < 0 ? 6 : m_impl->compressionLevel;
+        m_impl->compressor.reset(libdeflate_alloc_compressor(level));
+        if(!m_impl->compressor) {
+            return false;
+        }
+    }
+
+    libdeflate_compressor* compressor = m_impl->compressor.get();
+    if(compression == CompressionType::Gzip) {
+        out.resize(libdeflate_gzip_compress_bound(compressor, in.size()));
+        out.resize(libdeflate_gzip_compress(compressor, in.data(), in.size(), out.data(),
+                                            out.size()));
+    } else {
+        out.resize(libdeflate_zlib_compress_bound(compressor, in.size()));
+        out.resize(libdeflate_zlib_compress(compressor, in.data(), in.size(), out.data(),
+                                            out.size()));
+    }
+    return !out.empty();
+#else
+    // The stream is reset instead of initialized again, which keeps the allocated window.
+    const bool gzip   = compression == CompressionType::Gzip;
+    z_stream& zstrm   = gzip ? m_impl->gzip : m_impl->zlib;
+    bool& initialized = gzip ? m_impl->gzipInitialized : m_impl->zlibInitialized;
+    if(!initialized) {
+        const int windowBits = gzip ? 16 + MAX_WBITS : MAX_WBITS;
+        if(deflateInit2(&zstrm, m_impl->compressionLevel, Z_DEFLATED, windowBits, 8,
+                        Z_DEFAULT_STRATEGY)
+           != Z_OK) {
+            return false;
+        }
+        initialized = true;
+    } else if(deflateReset(&zstrm) != Z_OK) {
+        return false;
+    }
+
+    // The bound is large enough to compress everything at once.
+    out.resize(deflateBound(&zstrm, static_cast<uLong>(in.size())));
+    zstrm.next_in   = const_cast<Bytef*>(in.data());
+    zstrm.avail_in  = static_cast<uInt>(in.size());
+    zstrm.next_out  = out.data();
+    zstrm.avail_out = static_cast<uInt>(out.size());
+
+    if(::deflate(&zstrm, Z_FINISH) != Z_STREAM_END) {
+        out.clear();
+        return false;
+    }
+    out.resize(zstrm.total_out);
+    return true;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Functions
+
 CompressionType testCompression(const std::vector<unsigned char>& data)
 {
     if(isGzipCompressed(data)) {
         return CompressionType::Gzip;
     } else if(isZlibCompressed(data)) {
         return CompressionType::Zlib;
+    } else if(isLz4Compressed(data)) {
+        return CompressionType::Lz4;
     } else {
         return CompressionType::Uncompressed;
     }
@@ -24,12 +662,20 @@ bool inflate_gzip(std::ifstream& strm, std::vector<unsigned char>& data)
         return false;
     }
 
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::vector<unsigned char> compressed;
+    return readRemaining(strm, compressed) && inflate_gzip(compressed, data);
+#else
+    // Reserve the uncompressed size of the trailer, so that appending does not reallocate.
+    const size_t size = gzipUncompressedSize(strm);
+
     z_stream zstrm{};
     if(inflateInit2(&zstrm, 16 + MAX_WBITS) != Z_OK) {
         return false;
     }
 
     data.clear();
+    data.reserve(size);
     std::vector<char> inBuffer(GzipChunkSize);
     std::vector<unsigned char> outBuffer(GzipChunkSize);
 
@@ -62,55 +708,22 @@ bool inflate_gzip(std::ifstream& strm, std::vector<unsigned char>& data)
     inflateEnd(&zstrm);
 
     return ret == Z_STREAM_END;
+#endif
 }
 
 bool inflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
 {
-    // Just check that there is actually data
-    if(in.size() == 0) {
-        return true;
-    }
-
-    // Init zstream object
-    z_stream zstrm{};
-    zstrm.next_in  = const_cast<Bytef*>(in.data());
-    zstrm.avail_in = static_cast<uInt>(in.size());
-
-    // Start with a guess for output size
-    out.resize(in.size() * 2, 0);
-
-    //
-    if(inflateInit2(&zstrm, (16 + MAX_WBITS)) != Z_OK) {
-        return false;
-    }
-
-    int ret{0};
-    do {
-        // Set output buffer
-        zstrm.next_out  = reinterpret_cast<Bytef*>(out.data() + zstrm.total_out);
-        zstrm.avail_out = static_cast<uInt>(out.size()) - static_cast<uInt>(zstrm.total_out);
-
-        // Decompress the data
-        ret = inflate(&zstrm, Z_NO_FLUSH);
-        if(ret == Z_STREAM_ERROR || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
-            inflateEnd(&zstrm);
-            return false;
-        }
-
-        if(ret == Z_BUF_ERROR || ret == Z_OK) {
-            if(zstrm.avail_out == 0) {
-                size_t old_size = out.size();
-                out.resize(old_size * 2);
-            }
-        }
-    } while(ret != Z_STREAM_END);
-
-    out.resize(zstrm.total_out);
+    return inflate_gzip(std::span<const unsigned char>(in), out);
+}
 
-    // Clean up and free memory
-    inflateEnd(&zstrm);
+bool inflate_gzip(std::span<const unsigned char> in, std::vector<unsigned char>& out)
+{
+    return Inflater::threadLocal().inflate(CompressionType::Gzip, in, out);
+}
 
-    return true;
+bool inflate_gzip(std::span<const std::byte> in, std::vector<unsigned char>& out, size_t sizeHint)
+{
+    return Inflater::threadLocal().inflate(CompressionType::Gzip, in, out, sizeHint);
 }
 
 bool inflate_zlib(std::ifstream& strm, std::vector<unsigned char>& data)
@@ -119,6 +732,10 @@ bool inflate_zlib(std::ifstream& strm, std::vector<unsigned char>& data)
         return false;
     }
 
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::vector<unsigned char> compressed;
+    return readRemaining(strm, compressed) && inflate_zlib(compressed, data);
+#else
     z_stream zstrm{};
     if(inflateInit(&zstrm) != Z_OK) {
         return false;
@@ -156,43 +773,107 @@ bool inflate_zlib(std::ifstream& strm, std::vector<unsigned char>& data)
 
     inflateEnd(&zstrm);
     return ret == Z_STREAM_END;
+#endif
 }
 
 bool inflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
 {
+    return inflate_zlib(std::span<const unsigned char>(in), out);
+}
+
+bool inflate_zlib(std::span<const unsigned char> in, std::vector<unsigned char>& out)
+{
+    return Inflater::threadLocal().inflate(CompressionType::Zlib, in, out);
+}
+
+bool inflate_zlib(std::span<const std::byte> in, std::vector<unsigned char>& out, size_t sizeHint)
+{
+    return Inflater::threadLocal().inflate(CompressionType::Zlib, in, out, sizeHint);
+}
+
+bool isLz4Supported()
+{
+#if defined(CPPANVIL_HAS_LZ4)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool inflate_lz4(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+{
+    return inflate_lz4(std::span<const unsigned char>(in), out);
+}
+
+bool inflate_lz4(std::span<const unsigned char> in, std::vector<unsigned char>& out)
+{
+    out.clear();
+
     // Just check that there is actually data
-    if(in.size() == 0) {
+    if(in.empty()) {
         return true;
     }
 
-    // Init zstream object
-    z_stream zstrm{};
-    if(inflateInit(&zstrm) != Z_OK) {
-        return false;
-    }
-
-    zstrm.avail_in = in.size();
-    zstrm.next_in  = const_cast<Bytef*>(in.data());
+#if defined(CPPANVIL_HAS_LZ4)
+    size_t pos = 0;
+    while(pos < in.size()) {
+        const unsigned char* header = in.data() + pos;
+        if(in.size() - pos < Lz4BlockHeaderSize
+           || std::memcmp(header, Lz4BlockMagic, sizeof(Lz4BlockMagic)) != 0) {
+            return false;
+        }
+        const unsigned char method    = header[8] & 0xF0;
+        const size_t maxSize          = size_t{1} << ((header[8] & 0x0F) + Lz4CompressionBase);
+        const uint32_t compressedSize = readLittleEndian32(header + 9);
+        const uint32_t size           = readLittleEndian32(header + 13);
+        const uint32_t checksum       = readLittleEndian32(header + 17);
+        pos += Lz4BlockHeaderSize;
+
+        if(size > maxSize || compressedSize > in.size() - pos) {
+            return false;
+        }
 
-    int ret{0};
-    unsigned long prevOut{0};
-    do {
-        std::vector<unsigned char> buffer(ZlibChunkSize, 0);
-        zstrm.next_out  = reinterpret_cast<Bytef*>(buffer.data());
-        zstrm.avail_out = ZlibChunkSize;
+        // An empty block marks the end of the stream, nothing may follow it.
+        if(size == 0) {
+            return compressedSize == 0 && pos == in.size();
+        }
 
-        ret = inflate(&zstrm, 0);
-        out.insert(out.end(), buffer.begin(), buffer.begin() + (zstrm.total_out - prevOut));
-        prevOut = zstrm.total_out;
-    } while(ret == Z_OK);
+        const size_t offset = out.size();
+        out.resize(offset + size);
+        if(method == Lz4MethodRaw) {
+            if(compressedSize != size) {
+                return false;
+            }
+            std::memcpy(out.data() + offset, in.data() + pos, size);
+        } else if(method == Lz4MethodLz4) {
+            const int ret = LZ4_decompress_safe(reinterpret_cast<const char*>(in.data() + pos),
+                                                reinterpret_cast<char*>(out.data() + offset),
+                                                static_cast<int>(compressedSize),
+                                                static_cast<int>(size));
+            if(ret != static_cast<int>(size)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
 
-    inflateEnd(&zstrm);
-    if(ret != Z_STREAM_END) {
-        return false;
+        if((xxh32(out.data() + offset, size, Lz4ChecksumSeed) & Lz4ChecksumMask) != checksum) {
+            return false;
+        }
+        pos += compressedSize;
     }
 
-    out.resize(zstrm.total_out);
-    return true;
+    // The stream is truncated, the end marker is missing.
+    return false;
+#else
+    return false;
+#endif
+}
+
+bool inflate_lz4(std::span<const std::byte> in, std::vector<unsigned char>& out, size_t sizeHint)
+{
+    out.reserve(sizeHint);
+    return inflate_lz4(asUnsignedChars(in), out);
 }
 
 bool deflate_gzip(std::ofstream& strm, std::vector<unsigned char>& data, const int compressionLevel)
@@ -202,6 +883,10 @@ bool deflate_gzip(std::ofstream& strm, std::vector<unsigned char>& data, const i
         return true;
     }
 
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::vector<unsigned char> compressed;
+    return deflate_gzip(data, compressed, compressionLevel) && writeAll(strm, compressed);
+#else
     // Initialize zstream object
     z_stream zstrm{};
     if(deflateInit2(&zstrm, compressionLevel, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY)
@@ -235,42 +920,53 @@ bool deflate_gzip(std::ofstream& strm, std::vector<unsigned char>& data, const i
 
     deflateEnd(&zstrm);
     return ret == Z_STREAM_END;
+#endif
 }
 
 bool deflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
                   const int compressionLevel)
 {
-    // Just check that there is actually data
-    if(in.empty()) {
-        return true;
-    }
+    Deflater& deflater = Deflater::threadLocal();
+    deflater.setCompressionLevel(compressionLevel);
+    return deflater.deflate(CompressionType::Gzip, in, out);
+}
 
-    // Initialize zstream object
-    z_stream zstrm{};
-    if(deflateInit2(&zstrm, compressionLevel, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY)
-       != Z_OK) {
-        return false;
-    }
-    zstrm.next_in  = const_cast<Bytef*>(in.data());
-    zstrm.avail_in = static_cast<uInt>(in.size());
+bool deflate_gzip(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  const int compressionLevel)
+{
+    Deflater& deflater = Deflater::threadLocal();
+    deflater.setCompressionLevel(compressionLevel);
+    return deflater.deflate(CompressionType::Gzip, in, out);
+}
 
-    out.clear();
+bool deflate_gzip(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
+                  const int compressionLevel, size_t threadCount)
+{
+    if(in.size() <= ParallelBlockSize || detail::resolveThreadCount(threadCount, 2) == 1) {
+        return deflate_gzip(in, out, compressionLevel);
+    }
 
-    int ret{0};
-    std::vector<unsigned char> buffer(GzipChunkSize, 0);
-    do {
-        zstrm.next_out  = reinterpret_cast<Bytef*>(buffer.data());
-        zstrm.avail_out = GzipChunkSize;
+    // Minimal gzip header without file name and modification time, the operating system is
+    // unknown.
+    out.assign({0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xFF});
 
-        ret        = deflate(&zstrm, Z_FINISH);
-        uInt bytes = GzipChunkSize - zstrm.avail_out;
-        out.insert(out.end(), buffer.begin(), buffer.begin() + bytes);
-    } while(ret == Z_OK);
+    auto checksum = [](uLong crc, const unsigned char* data, size_t size) {
+        return crc32(crc, data, static_cast<uInt>(size));
+    };
+    auto combine = [](uLong crc1, uLong crc2, size_t size) {
+        return crc32_combine(crc1, crc2, static_cast<z_off_t>(size));
+    };
 
-    // Resize the output buffer to the actual compressed size
-    out.resize(zstrm.total_out);
+    uLong check{0};
+    if(!deflateParallel(in, out, compressionLevel, threadCount, checksum, combine, check)) {
+        out.clear();
+        return false;
+    }
 
-    deflateEnd(&zstrm);
+    const size_t offset = out.size();
+    out.resize(offset + 8);
+    writeLittleEndian32(out.data() + offset, static_cast<uint32_t>(check));
+    writeLittleEndian32(out.data() + offset + 4, static_cast<uint32_t>(in.size()));
     return true;
 }
 
@@ -281,6 +977,10 @@ bool deflate_zlib(std::ofstream& strm, std::vector<unsigned char>& data, const i
         return true;
     }
 
+#if defined(CPPANVIL_HAS_LIBDEFLATE)
+    std::vector<unsigned char> compressed;
+    return deflate_zlib(data, compressed, compressionLevel) && writeAll(strm, compressed);
+#else
     // Initialize zstream object
     z_stream zstrm{};
     if(deflateInit(&zstrm, compressionLevel) != Z_OK) {
@@ -313,43 +1013,67 @@ bool deflate_zlib(std::ofstream& strm, std::vector<unsigned char>& data, const i
 
     deflateEnd(&zstrm);
     return ret == Z_STREAM_END;
+#endif
 }
 
 bool deflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
                   const int compressionLevel)
 {
-    // Just check that there is actually data
-    if(in.empty()) {
-        return true;
+    Deflater& deflater = Deflater::threadLocal();
+    deflater.setCompressionLevel(compressionLevel);
+    return deflater.deflate(CompressionType::Zlib, in, out);
+}
+
+bool deflate_zlib(std::span<const std::byte> in, std::vector<unsigned char>& out,
+                  const int compressionLevel)
+{
+    Deflater& deflater = Deflater::threadLocal();
+    deflater.setCompressionLevel(compressionLevel);
+    return deflater.deflate(CompressionType::Zlib, in, out);
+}
+
+bool deflate_zlib(const std::vector<unsigned char>& in, std::vector<unsigned char>& out,
+                  const int compressionLevel, size_t threadCount)
+{
+    if(in.size() <= ParallelBlockSize || detail::resolveThreadCount(threadCount, 2) == 1) {
+        return deflate_zlib(in, out, compressionLevel);
     }
 
-    // Initialize zstream object
-    z_stream zstrm{};
-    if(deflateInit(&zstrm, compressionLevel) != Z_OK) {
+    // The zlib header announces the compression level in 4 steps, like deflate() does.
+    const int level  = compressionLevel == DefaultCompression ? 6 : compressionLevel;
+    const int flevel = level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3));
+    unsigned header  = (0x78u << 8) | (static_cast<unsigned>(flevel) << 6);
+    header += 31 - header % 31;
+    out.assign({static_cast<unsigned char>(header >> 8), static_cast<unsigned char>(header)});
+
+    auto checksum = [](uLong adler, const unsigned char* data, size_t size) {
+        return adler32(adler, data, static_cast<uInt>(size));
+    };
+    auto combine = [](uLong adler1, uLong adler2, size_t size) {
+        return adler32_combine(adler1, adler2, static_cast<z_off_t>(size));
+    };
+
+    uLong check{0};
+    if(!deflateParallel(in, out, compressionLevel, threadCount, checksum, combine, check)) {
+        out.clear();
         return false;
     }
-    zstrm.next_in  = const_cast<Bytef*>(in.data());
-    zstrm.avail_in = static_cast<uInt>(in.size());
-
-    // Initial output buffer size, if we need more it can grow.
-    out.clear();
-
-    int ret{0};
-    std::vector<unsigned char> buffer(ZlibChunkSize, 0);
-    do {
-        zstrm.next_out  = reinterpret_cast<Bytef*>(buffer.data());
-        zstrm.avail_out = ZlibChunkSize;
 
-        ret        = deflate(&zstrm, Z_FINISH);
-        uInt bytes = ZlibChunkSize - zstrm.avail_out;
-        out.insert(out.end(), buffer.begin(), buffer.begin() + bytes);
-    } while(ret == Z_OK);
+    // The Adler-32 checksum is stored big endian.
+    for(int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<unsigned char>(check >> shift));
+    }
+    return true;
+}
 
-    // Resize the output buffer to the actual compressed size
-    out.resize(zstrm.total_out);
+bool deflate_lz4(const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+{
+    return deflateLz4(in, out);
+}
 
-    deflateEnd(&zstrm);
-    return true;
+bool deflate_lz4(std::span<const std::byte> in, std::vector<unsigned char>& out)
+{
+    return deflateLz4(asUnsignedChars(in), out);
 }
 
 } // namespace anvil
@@ -0,0 +1,57 @@
+#ifndef CPP_ANVIL_UTIL_MEMORY_MAPPED_FILE_HPP
+#define CPP_ANVIL_UTIL_MEMORY_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace anvil {
+
+//! @brief Read-only memory mapping of a whole file.
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() = default;
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    //! @brief Maps the file @p filename into memory.
+    //! @details
+    //! A previously mapped file is unmapped before.
+    //!
+    //! @param filename File to be mapped.
+    //! @return `true` if the file could be mapped, `false` otherwise.
+    bool open(const std::string& filename);
+
+    //! @brief Unmaps the file.
+    void close();
+
+    //! @brief Returns whether a file is currently mapped.
+    bool isOpen() const { return m_data != nullptr; }
+
+    //! @brief Returns pointer to the first byte of the mapped file.
+    const unsigned char* data() const { return m_data; }
+
+    //! @brief Returns the size of the mapped file in bytes.
+    size_t size() const { return m_size; }
+
+    //! @brief Returns a view of @p length bytes beginning at @p offset.
+    //! @return The requested bytes or an empty span if the range exceeds the mapped file.
+    std::span<const unsigned char> bytes(size_t offset, size_t length) const;
+
+private:
+    const unsigned char* m_data{nullptr};
+    size_t m_size{0};
+#if defined(_WIN32)
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#endif
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_UTIL_MEMORY_MAPPED_FILE_HPP
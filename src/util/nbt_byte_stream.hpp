@@ -12,7 +12,9 @@
 #include <cstdint>
 #include <cstring>
 #include <istream>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace anvil {
@@ -27,7 +29,7 @@ class NbtInputByteStream
     static constexpr auto EndOfStream{static_cast<size_type>(0)};
 
 public:
-    explicit NbtInputByteStream(std::vector<char_type>& data)
+    explicit NbtInputByteStream(const std::vector<char_type>& data)
         : m_buffer(data)
         , m_pos(0)
     { }
@@ -67,24 +69,61 @@ public:
     {
         T vec;
 
+        using value_type = typename T::value_type;
+
         int32_t size = read<int32_t>();
-        if(availableBytes() < size) {
+        if(size < 0 || availableBytes() / sizeof(value_type) < static_cast<size_type>(size)) {
             throw std::runtime_error("Unexpected end of stream.");
         }
         vec.resize(size);
-        for(int32_t i = 0; i < size; ++i) {
-            vec[i] = read<typename T::value_type>();
-        }
+        detail::copyFromBigEndian(vec.data(), m_buffer.data() + m_pos, vec.size());
+        m_pos += vec.size() * sizeof(value_type);
         return vec;
     }
 
+    // Reads a string without copying it, the view points into the buffer.
+    std::string_view readStringView()
+    {
+        uint16_t length = read<uint16_t>();
+        if(availableBytes() < length) {
+            throw std::runtime_error("Unexpected end of stream.");
+        }
+
+        std::string_view str(reinterpret_cast<const char*>(&m_buffer[m_pos]), length);
+        m_pos += length;
+
+        return str;
+    }
+
+    // Reads an array into a reusable buffer. Byte arrays are not copied, the span points into the
+    // stream buffer.
+    template<typename T>
+    std::span<const T> readArray(std::vector<T>& values)
+    {
+        int32_t size = read<int32_t>();
+        if(size < 0 || availableBytes() / sizeof(T) < static_cast<size_type>(size)) {
+            throw std::runtime_error("Unexpected end of stream.");
+        }
+
+        if constexpr(sizeof(T) == 1) {
+            std::span<const T> array(reinterpret_cast<const T*>(&m_buffer[m_pos]), size);
+            m_pos += size;
+            return array;
+        } else {
+            values.resize(size);
+            detail::copyFromBigEndian(values.data(), m_buffer.data() + m_pos, values.size());
+            m_pos += values.size() * sizeof(T);
+            return values;
+        }
+    }
+
 private:
-    std::vector<char_type>& m_buffer;
+    const std::vector<char_type>& m_buffer;
     size_type m_pos;
 };
 
 template<>
-TagType NbtInputByteStream::read()
+inline TagType NbtInputByteStream::read()
 {
     if(availableBytes() > 0) {
         TagType t = static_cast<TagType>(m_buffer[m_pos]);
@@ -97,7 +136,7 @@ TagType NbtInputByteStream::read()
 }
 
 template<>
-StringType NbtInputByteStream::read()
+inline StringType NbtInputByteStream::read()
 {
     uint16_t length = read<uint16_t>();
     if(availableBytes() < length) {
@@ -0,0 +1,84 @@
+#ifndef CPP_ANVIL_UTIL_PARALLEL_HPP
+#define CPP_ANVIL_UTIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace anvil {
+namespace detail {
+
+//! @brief Resolves the number of worker threads to use.
+//! @param threadCount Requested number of threads. `0` selects the hardware concurrency.
+//! @param workItems Number of work items, more threads than items are never used.
+//! @return Number of threads, at least 1.
+inline size_t resolveThreadCount(size_t threadCount, size_t workItems)
+{
+    if(threadCount == 0) {
+        threadCount = std::max<size_t>(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(1u, std::min(threadCount, workItems));
+}
+
+//! @brief Calls @p func for every index in [0, count) distributed over @p threadCount threads.
+//! @details
+//! The calling thread takes part in the work. Work items are handed out one by one, so the
+//! order in which they are processed is not defined. If any invocation throws, no further items
+//! are started and the first exception is rethrown after all threads have finished.
+//!
+//! @param count Number of work items.
+//! @param threadCount Number of threads. `0` selects the hardware concurrency.
+//! @param func Callable taking the index of the work item.
+template<typename Func>
+void parallelFor(size_t count, size_t threadCount, Func&& func)
+{
+    threadCount = resolveThreadCount(threadCount, count);
+    if(threadCount == 1) {
+        for(size_t index = 0; index < count; ++index) {
+            func(index);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]() {
+        for(size_t index = nextIndex++; index < count && !failed; index = nextIndex++) {
+            try {
+                func(index);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if(!exception) {
+                    exception = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for(size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    if(exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace detail
+} // namespace anvil
+
+#endif // CPP_ANVIL_UTIL_PARALLEL_HPP
@@ -0,0 +1,166 @@
+// Internal headers
+#include "util/random_access_file.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace anvil {
+
+RandomAccessFile::RandomAccessFile(RandomAccessFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+RandomAccessFile::~RandomAccessFile()
+{
+    close();
+}
+
+RandomAccessFile& RandomAccessFile::operator=(RandomAccessFile&& other) noexcept
+{
+    if(this != &other) {
+        close();
+        m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN32)
+        m_file = std::exchange(other.m_file, nullptr);
+#else
+        m_fd = std::exchange(other.m_fd, -1);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool RandomAccessFile::open(const std::string& filename)
+{
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize{};
+    if(!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void RandomAccessFile::close()
+{
+    if(m_file) {
+        CloseHandle(m_file);
+    }
+    m_file = nullptr;
+    m_size = 0;
+}
+
+bool RandomAccessFile::isOpen() const
+{
+    return m_file != nullptr;
+}
+
+size_t RandomAccessFile::readAt(size_t offset, unsigned char* data, size_t length) const
+{
+    size_t total = 0;
+    while(total < length) {
+        OVERLAPPED overlapped{};
+        const unsigned long long position = offset + total;
+        overlapped.Offset                 = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh             = static_cast<DWORD>(position >> 32);
+
+        DWORD bytesRead = 0;
+        DWORD request   = static_cast<DWORD>(std::min<size_t>(length - total, 0x40000000u));
+        if(!ReadFile(m_file, data + total, request, &bytesRead, &overlapped)) {
+            if(GetLastError() == ERROR_HANDLE_EOF) {
+                break;
+            }
+            throw std::runtime_error("Failed to read file.");
+        }
+        if(bytesRead == 0) {
+            break;
+        }
+        total += bytesRead;
+    }
+    return total;
+}
+
+#else
+
+bool RandomAccessFile::open(const std::string& filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    struct stat fileStat{};
+    if(::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd   = fd;
+    m_size = static_cast<size_t>(fileStat.st_size);
+    return true;
+}
+
+void RandomAccessFile::close()
+{
+    if(m_fd >= 0) {
+        ::close(m_fd);
+    }
+    m_fd   = -1;
+    m_size = 0;
+}
+
+bool RandomAccessFile::isOpen() const
+{
+    return m_fd >= 0;
+}
+
+size_t RandomAccessFile::readAt(size_t offset, unsigned char* data, size_t length) const
+{
+    size_t total = 0;
+    while(total < length) {
+        ssize_t bytesRead = ::pread(m_fd, data + total, length - total,
+                                    static_cast<off_t>(offset + total));
+        if(bytesRead < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to read file.");
+        }
+        if(bytesRead == 0) {
+            break;
+        }
+        total += static_cast<size_t>(bytesRead);
+    }
+    return total;
+}
+
+#endif
+
+} // namespace anvil
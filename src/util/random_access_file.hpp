@@ -0,0 +1,65 @@
+#ifndef CPP_ANVIL_UTIL_RANDOM_ACCESS_FILE_HPP
+#define CPP_ANVIL_UTIL_RANDOM_ACCESS_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace anvil {
+
+//! @brief Read-only file with positional reads.
+//! @details
+//! Reads do not change a shared file position, so one file can be read by several threads at
+//! the same time.
+class RandomAccessFile
+{
+public:
+    RandomAccessFile() = default;
+    RandomAccessFile(const RandomAccessFile&) = delete;
+    RandomAccessFile(RandomAccessFile&& other) noexcept;
+    ~RandomAccessFile();
+
+    RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+    RandomAccessFile& operator=(RandomAccessFile&& other) noexcept;
+
+    //! @brief Opens the file @p filename for reading.
+    //! @details
+    //! A previously opened file is closed before.
+    //!
+    //! @param filename File to be opened.
+    //! @return `true` if the file could be opened, `false` otherwise.
+    bool open(const std::string& filename);
+
+    //! @brief Closes the file.
+    void close();
+
+    //! @brief Returns whether a file is currently open.
+    bool isOpen() const;
+
+    //! @brief Returns the size of the file in bytes, determined when the file was opened.
+    size_t size() const { return m_size; }
+
+    //! @brief Reads up to @p length bytes beginning at @p offset.
+    //! @param offset Position in the file.
+    //! @param data Destination, must hold at least @p length bytes.
+    //! @param length Number of bytes to read.
+    //! @return Number of bytes read, less than @p length only at the end of the file.
+    //! @throws std::runtime_error If the file can not be read.
+    size_t readAt(size_t offset, unsigned char* data, size_t length) const;
+
+#if !defined(_WIN32)
+    //! @brief Returns the file descriptor.
+    int nativeHandle() const { return m_fd; }
+#endif
+
+private:
+    size_t m_size{0};
+#if defined(_WIN32)
+    void* m_file{nullptr};
+#else
+    int m_fd{-1};
+#endif
+};
+
+} // namespace anvil
+
+#endif // CPP_ANVIL_UTIL_RANDOM_ACCESS_FILE_HPP
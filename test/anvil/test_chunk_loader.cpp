@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/anvil.hpp>
+#include <cpp-anvil/nbt.hpp>
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+
+#include "test_region_data.hpp"
+
+TEST(ChunkLoader, load_regions)
+{
+    const std::filesystem::path directory = test::testDirectory();
+    const std::string first  = test::writeTestRegion(directory, {0, 0}, test::everyNthChunk(5));
+    const std::string second = test::writeTestRegion(directory, {1, 0}, test::everyNthChunk(5));
+    const std::string broken = first + ".missing";
+
+    for(bool useIoUring : {false, true}) {
+        std::mutex mutex;
+        std::map<std::pair<std::string, size_t>, int32_t> loaded;
+        std::vector<std::string> failedRegions;
+
+        anvil::ChunkLoader::Options options;
+        options.ioThreads     = 2;
+        options.decodeThreads = 3;
+        options.queueDepth    = 8;
+        options.useIoUring    = useIoUring;
+        anvil::ChunkLoader loader(
+            [&](anvil::ChunkLoader::Result&& result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(result.error) {
+                    EXPECT_EQ(result.index, anvil::Region::Chunks);
+                    failedRegions.push_back(result.filename);
+                    return;
+                }
+                loaded[{result.filename, result.index}] = result.chunk.xPos();
+            },
+            options);
+        // Without io_uring support the second pass runs the thread pool as well, it does not
+        // test the io_uring backend then.
+        const bool ioUring = useIoUring && anvil::ChunkLoader::isIoUringSupported();
+        EXPECT_EQ(loader.backend(), ioUring ? anvil::ChunkLoader::Backend::IoUring
+                                            : anvil::ChunkLoader::Backend::ThreadPool);
+
+        loader.load(first);
+        loader.load(second, {0, 1, 5, 10, 10, 1023});
+        loader.load(broken);
+        loader.wait();
+
+        EXPECT_EQ(loaded.size(), 205u + 3u);
+        EXPECT_EQ((loaded[{first, 1020}]), 28);
+        EXPECT_EQ((loaded[{second, 10}]), 42);
+        EXPECT_EQ(loaded.count({second, 1}), 0u);
+        ASSERT_EQ(failedRegions.size(), 1u);
+        EXPECT_EQ(failedRegions.front(), broken);
+    }
+}
+
+TEST(ChunkLoader, callback_exception)
+{
+    const std::string filename = test::writeTestRegion({0});
+
+    anvil::ChunkLoader loader([](anvil::ChunkLoader::Result&&) {
+        throw std::runtime_error("callback");
+    });
+    loader.load(filename, {0});
+    EXPECT_THROW(loader.wait(), std::runtime_error);
+    EXPECT_THROW(loader.load(filename, {anvil::Region::Chunks}), std::out_of_range);
+}
@@ -0,0 +1,660 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/anvil.hpp>
+#include <cpp-anvil/nbt.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "test_region_data.hpp"
+
+TEST(Region, save_load_stream)
+{
+    const std::vector<size_t> indices{0, 1, 33, 512, 1023};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.loadFromFile(filename);
+    EXPECT_EQ(region.fileAccess(), anvil::Region::FileAccess::Stream);
+
+    for(size_t index : indices) {
+        ASSERT_TRUE(region.isChunkLoaded(index));
+        EXPECT_EQ(region.chunkAt(index).xPos(), anvil::Region::fromIndex(index).x);
+        EXPECT_EQ(region.chunkAt(index).zPos(), anvil::Region::fromIndex(index).z);
+    }
+    EXPECT_FALSE(region.isChunkLoadable(2));
+}
+
+TEST(Region, load_memory_mapped)
+{
+    const std::vector<size_t> indices{0, 5, 64, 1000};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region streamed;
+    streamed.loadFromFile(filename);
+
+    anvil::Region mapped;
+    mapped.loadPartiallyFromFile(filename, anvil::Region::FileAccess::MemoryMapped);
+    EXPECT_EQ(mapped.fileAccess(), anvil::Region::FileAccess::MemoryMapped);
+
+    mapped.loadChunkAt(64);
+    EXPECT_TRUE(mapped.isChunkLoaded(64));
+    EXPECT_FALSE(mapped.isChunkLoaded(0));
+
+    mapped.loadAllChunks();
+    for(size_t index : indices) {
+        ASSERT_TRUE(mapped.isChunkLoaded(index));
+        EXPECT_EQ(*mapped.chunkAt(index).rootTag(), *streamed.chunkAt(index).rootTag());
+    }
+
+    // Saving over the mapped source file must keep the region usable.
+    EXPECT_TRUE(mapped.saveToFile());
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename, anvil::Region::FileAccess::MemoryMapped);
+    EXPECT_EQ(reloaded.chunkAt(1000).xPos(), anvil::Region::fromIndex(1000).x);
+}
+
+TEST(Region, load_all_chunks_parallel)
+{
+    std::vector<size_t> indices;
+    for(size_t index = 0; index < anvil::Region::Chunks; index += 7) {
+        indices.push_back(index);
+    }
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region serial;
+    serial.loadFromFile(filename);
+
+    using FileAccess = anvil::Region::FileAccess;
+    for(auto access : {FileAccess::Stream, FileAccess::MemoryMapped}) {
+        anvil::Region parallel;
+        parallel.loadPartiallyFromFile(filename, access);
+        parallel.loadChunkAt(14);
+        parallel.loadAllChunks(4);
+
+        for(size_t index = 0; index < anvil::Region::Chunks; ++index) {
+            ASSERT_EQ(parallel.isChunkLoaded(index), serial.isChunkLoaded(index));
+            if(serial.isChunkLoaded(index)) {
+                EXPECT_EQ(*parallel.chunkAt(index).rootTag(), *serial.chunkAt(index).rootTag());
+            }
+        }
+    }
+}
+
+TEST(Region, save_parallel_identical)
+{
+    std::vector<size_t> indices;
+    for(size_t index = 0; index < anvil::Region::Chunks; index += 3) {
+        indices.push_back(index);
+    }
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.loadFromFile(filename);
+
+    std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+    ASSERT_TRUE(region.saveToFile((dir / "serial.mca").string()));
+    ASSERT_TRUE(region.saveToFile((dir / "parallel.mca").string(), 4));
+
+    auto readAll = [](const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), {});
+    };
+    EXPECT_EQ(readAll(dir / "serial.mca"), readAll(dir / "parallel.mca"));
+}
+
+TEST(Region, save_changes_incremental)
+{
+    const std::vector<size_t> indices{0, 1, 2, 100, 700};
+    const std::string filename = test::writeTestRegion(indices);
+    const auto originalSize    = std::filesystem::file_size(filename);
+
+    {
+        anvil::Region region;
+        region.loadFromFile(filename);
+
+        const anvil::Region& constRegion = region;
+        EXPECT_EQ(constRegion.chunkAt(2).xPos(), 2);
+        EXPECT_FALSE(region.isChunkDirty(2));
+
+        // Grow chunk 1 so it no longer fits into its sectors, modify chunk 100 in place, drop
+        // chunk 700 and add the new chunk 5.
+        auto* root = region.chunkAt(1).rootTag();
+        std::vector<anvil::ByteType> noise(20000);
+        for(size_t i = 0; i < noise.size(); ++i) {
+            noise[i] = static_cast<anvil::ByteType>((i * 7919u) >> 3);
+        }
+        root->push_back(std::make_unique<anvil::ByteArrayTag>("noise", noise));
+        region.chunkAt(100).rootTag()->getChildByName("yPos")->asIntTag()->setValue(8);
+        region.chunkAt(700).clear();
+        region.chunkAt(5).setRootTag(test::makeChunkTag(anvil::Region::fromIndex(5)));
+        EXPECT_TRUE(region.isChunkDirty(1));
+
+        // Only accessed, not loaded: must be kept.
+        region.chunkAt(3);
+        EXPECT_FALSE(region.isChunkDirty(3));
+
+        ASSERT_TRUE(region.saveChanges());
+        EXPECT_FALSE(region.isChunkDirty(1));
+    }
+
+    // Chunk 1 no longer fits into the file and has been appended.
+    EXPECT_GT(std::filesystem::file_size(filename), originalSize);
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename);
+    const anvil::Region& region = reloaded;
+    EXPECT_EQ(region.chunkAt(0).xPos(), 0);
+    EXPECT_TRUE(region.chunkAt(1).rootTag()->hasChild("noise"));
+    EXPECT_EQ(region.chunkAt(2).xPos(), 2);
+    EXPECT_EQ(region.chunkAt(5).xPos(), 5);
+    EXPECT_EQ(region.chunkAt(100).yPos(), 8);
+    EXPECT_FALSE(region.isChunkLoadable(700));
+}
+
+TEST(Region, save_raw_passthrough)
+{
+    const std::vector<size_t> indices{0, 10, 20, 900};
+    const std::string filename = test::writeTestRegion(indices);
+
+    std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+    auto readAll              = [](const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), {});
+    };
+
+    // Unmodified and unloaded chunks are written unchanged.
+    anvil::Region region;
+    region.loadPartiallyFromFile(filename);
+    region.loadChunkAt(10);
+    const anvil::Region& constRegion = region;
+    EXPECT_EQ(constRegion.chunkAt(10).xPos(), 10);
+    ASSERT_TRUE(region.saveToFile((dir / "passthrough.mca").string()));
+    EXPECT_EQ(readAll(filename), readAll(dir / "passthrough.mca"));
+
+    // Modified chunks are serialized again.
+    region.chunkAt(10).rootTag()->getChildByName("yPos")->asIntTag()->setValue(3);
+    region.markChunkDirty(10);
+    EXPECT_TRUE(region.rawChunkData(10).empty());
+    EXPECT_FALSE(region.rawChunkData(20).empty());
+    ASSERT_TRUE(region.saveToFile((dir / "r.2.0.mca").string()));
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile((dir / "r.2.0.mca").string());
+    EXPECT_EQ(reloaded.chunkAt(10).yPos(), 3);
+    EXPECT_EQ(reloaded.chunkAt(900).xPos(), anvil::Region::fromIndex(900).x);
+}
+
+TEST(Region, save_raw_passthrough_unmarked)
+{
+    const std::string filename = test::writeTestRegion({0, 10, 20});
+    std::filesystem::path dir  = std::filesystem::path(filename).parent_path();
+
+    anvil::Region original;
+    original.loadPartiallyFromFile(filename);
+
+    using FileAccess = anvil::Region::FileAccess;
+    for(auto access : {FileAccess::Stream, FileAccess::MemoryMapped}) {
+        anvil::Region region;
+        region.loadPartiallyFromFile(filename, access);
+        region.loadAllChunks();
+
+        // Chunk 10 is only read, chunk 20 is changed without marking it.
+        EXPECT_EQ(region.chunkAt(10).xPos(), 10);
+        region.chunkAt(20).rootTag()->getChildByName("yPos")->asIntTag()->setValue(5);
+        EXPECT_FALSE(region.rawChunkData(10).empty());
+        EXPECT_TRUE(region.rawChunkData(20).empty());
+
+        const std::string savedName = (dir / "r.3.0.mca").string();
+        ASSERT_TRUE(region.saveToFile(savedName));
+
+        anvil::Region saved;
+        saved.loadFromFile(savedName);
+        for(size_t index : {0, 10}) {
+            const auto expected = original.rawChunkData(index);
+            const auto actual   = saved.rawChunkData(index);
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end()));
+        }
+        EXPECT_EQ(saved.chunkAt(20).yPos(), 5);
+    }
+}
+
+TEST(Region, raw_chunk_copy)
+{
+    const std::string filename = test::writeTestRegion({0, 7});
+
+    using FileAccess = anvil::Region::FileAccess;
+    for(auto access : {FileAccess::Stream, FileAccess::MemoryMapped}) {
+        anvil::Region source;
+        source.loadPartiallyFromFile(filename, access);
+        ASSERT_FALSE(source.rawChunkData(7).empty());
+        EXPECT_TRUE(source.rawChunkData(8).empty());
+        EXPECT_EQ(source.rawChunkCompression(7), anvil::CompressionType::Uncompressed);
+
+        // Copy chunk 7 of the source to index 3 without parsing it.
+        const std::string copyName =
+            (std::filesystem::path(filename).parent_path() / "r.1.0.mca").string();
+        {
+            anvil::Region target;
+            target.setRawChunkData(3, source.rawChunkData(7), source.rawChunkCompression(7));
+            EXPECT_TRUE(target.isChunkLoadable(3));
+            EXPECT_FALSE(target.isChunkLoaded(3));
+            ASSERT_TRUE(target.saveToFile(copyName));
+        }
+
+        anvil::Region copy;
+        copy.loadFromFile(copyName);
+        ASSERT_TRUE(copy.isChunkLoaded(3));
+        EXPECT_EQ(copy.chunkAt(3).xPos(), 7);
+        EXPECT_FALSE(copy.isChunkLoadable(7));
+
+        // Copy into an existing file with incremental saving.
+        copy.setRawChunkData(5, source.rawChunkData(0), source.rawChunkCompression(0));
+        ASSERT_TRUE(copy.saveChanges());
+        anvil::Region updated;
+        updated.loadFromFile(copyName, access);
+        EXPECT_EQ(updated.chunkAt(5).xPos(), 0);
+        EXPECT_EQ(updated.chunkAt(3).xPos(), 7);
+    }
+}
+
+TEST(Region, reload_discards_chunks)
+{
+    const std::string first  = test::writeTestRegion({3, 9});
+    const std::string second = (std::filesystem::path(first).parent_path() / "r.4.0.mca").string();
+    std::filesystem::copy_file(first, second, std::filesystem::copy_options::overwrite_existing);
+    const std::string filename = test::writeTestRegion({0, 7});
+
+    anvil::Region region;
+    region.loadFromFile(filename);
+    region.setRawChunkData(3, region.rawChunkData(7), region.rawChunkCompression(7));
+    region.chunkAt(0).rootTag()->getChildByName("yPos")->asIntTag()->setValue(5);
+    region.markChunkDirty(0);
+
+    // Neither the raw data of chunk 3 nor the modified chunk 0 belong to the second file.
+    region.loadFromFile(second);
+    EXPECT_FALSE(region.hasUnsavedChanges());
+    EXPECT_FALSE(region.isChunkDirty(3));
+    EXPECT_FALSE(region.isChunkLoadable(0));
+    EXPECT_FALSE(region.isChunkLoadable(7));
+    EXPECT_EQ(region.chunkAt(3).xPos(), 3);
+    EXPECT_FALSE(region.rawChunkData(3).empty());
+
+    const std::string copyName =
+        (std::filesystem::path(filename).parent_path() / "r.5.0.mca").string();
+    ASSERT_TRUE(region.saveToFile(copyName));
+    auto readAll = [](const std::string& path) {
+        std::ifstream stream(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), {});
+    };
+    EXPECT_EQ(readAll(copyName), readAll(second));
+}
+
+TEST(Region, lazy_loading)
+{
+    const std::vector<size_t> indices{0, 40, 41, 999};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.setLazyLoading(true);
+    region.loadFromFile(filename);
+    EXPECT_TRUE(region.isLazyLoading());
+    for(size_t index : indices) {
+        EXPECT_FALSE(region.isChunkLoaded(index));
+    }
+
+    const anvil::Region& constRegion = region;
+    EXPECT_EQ(constRegion.chunkAt(8, 1).xPos(), 8);
+    EXPECT_TRUE(region.isChunkLoaded(40));
+    EXPECT_FALSE(region.isChunkDirty(40));
+    EXPECT_FALSE(region.isChunkLoaded(41));
+    EXPECT_TRUE(constRegion.chunkAt(2).empty());
+
+    region.chunkAt(999).rootTag()->getChildByName("yPos")->asIntTag()->setValue(-2);
+    region.markChunkDirty(999);
+    EXPECT_TRUE(region.isChunkDirty(999));
+    ASSERT_TRUE(region.saveChanges());
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename);
+    EXPECT_EQ(reloaded.chunkAt(999).yPos(), -2);
+    EXPECT_EQ(reloaded.chunkAt(41).xPos(), 9);
+}
+
+TEST(Region, unload_chunks)
+{
+    const std::vector<size_t> indices{0, 40, 41, 999};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.setLazyLoading(true);
+    region.loadFromFile(filename);
+    const size_t emptyUsage = region.memoryUsage();
+
+    const anvil::Region& constRegion = region;
+    EXPECT_EQ(constRegion.chunkAt(40).xPos(), 8);
+    EXPECT_EQ(constRegion.chunkAt(41).xPos(), 9);
+    region.chunkAt(0).rootTag()->getChildByName("yPos")->asIntTag()->setValue(-2);
+    region.markChunkDirty(0);
+    EXPECT_EQ(region.loadedChunkCount(), 3u);
+    EXPECT_GT(region.memoryUsage(), emptyUsage);
+
+    // Modified chunks stay loaded.
+    EXPECT_TRUE(region.unloadChunk(40));
+    EXPECT_FALSE(region.isChunkLoaded(40));
+    EXPECT_FALSE(region.unloadChunk(0));
+    EXPECT_EQ(region.unloadAll(), 1u);
+    EXPECT_EQ(region.loadedChunkCount(), 1u);
+    EXPECT_TRUE(region.hasUnsavedChanges());
+
+    // Unloaded chunks are loaded again on access.
+    EXPECT_EQ(constRegion.chunkAt(41).xPos(), 9);
+    ASSERT_TRUE(region.saveChanges());
+    EXPECT_EQ(region.unloadAll(), 2u);
+    EXPECT_EQ(region.memoryUsage(), emptyUsage);
+    EXPECT_EQ(region.chunkAt(0).yPos(), -2);
+    EXPECT_THROW(region.unloadChunk(anvil::Region::Chunks), std::out_of_range);
+}
+
+TEST(Region, read_access_is_not_a_change)
+{
+    const std::string filename = test::writeTestRegion({0, 40});
+    const auto lastWrite       = std::filesystem::last_write_time(filename);
+
+    anvil::Region region;
+    region.setLazyLoading(true);
+    region.loadFromFile(filename);
+
+    // Reading through the non-const overloads neither dirties nor pins the chunk.
+    EXPECT_EQ(region.chunkAt(0).xPos(), 0);
+    EXPECT_EQ(region.chunkAt(8, 1).xPos(), 8);
+    EXPECT_FALSE(region.isChunkDirty(0));
+    EXPECT_FALSE(region.hasUnsavedChanges());
+    EXPECT_FALSE(region.rawChunkData(0).empty());
+    EXPECT_TRUE(region.unloadChunk(0));
+    EXPECT_EQ(region.unloadAll(), 1u);
+    EXPECT_EQ(region.loadedChunkCount(), 0u);
+
+    ASSERT_TRUE(region.saveChanges());
+    EXPECT_EQ(std::filesystem::last_write_time(filename), lastWrite);
+}
+
+TEST(Region, unmarked_changes_are_saved)
+{
+    const std::string filename = test::writeTestRegion({0, 1, 2});
+    {
+        anvil::Region region;
+        region.setLazyLoading(true);
+        region.loadFromFile(filename);
+
+        // Changes through the non-const overloads are saved without markChunkDirty().
+        region.chunkAt(0).rootTag()->getChildByName("yPos")->asIntTag()->setValue(99);
+        region.chunkAt(1).clear();
+        EXPECT_EQ(region.chunkAt(2).xPos(), 2);
+        EXPECT_TRUE(region.isChunkDirty(0));
+        EXPECT_TRUE(region.isChunkDirty(1));
+        EXPECT_FALSE(region.isChunkDirty(2));
+        EXPECT_TRUE(region.hasUnsavedChanges());
+        EXPECT_FALSE(region.unloadChunk(0));
+        ASSERT_TRUE(region.saveToFile());
+        EXPECT_FALSE(region.hasUnsavedChanges());
+
+        // The references stay valid after saving.
+        region.chunkAt(2).rootTag()->getChildByName("yPos")->asIntTag()->setValue(7);
+        EXPECT_TRUE(region.isChunkDirty(2));
+        ASSERT_TRUE(region.saveChanges());
+
+        // After committing, changes must be marked again.
+        EXPECT_FALSE(region.commitChunk(2));
+        region.chunkAt(2);
+        EXPECT_FALSE(region.isChunkDirty(2));
+    }
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename);
+    EXPECT_EQ(reloaded.chunkAt(0).rootTag()->getChildByName("yPos")->asIntTag()->value(), 99);
+    EXPECT_FALSE(reloaded.isChunkLoadable(1));
+    EXPECT_EQ(reloaded.chunkAt(2).rootTag()->getChildByName("yPos")->asIntTag()->value(), 7);
+}
+
+TEST(Region, invalid_header_entry)
+{
+    const std::string filename = test::writeTestRegion({0, 1, 2});
+
+    // Let chunk 1 point behind the end of the file.
+    {
+        std::fstream stream(filename, std::ios::binary | std::ios::in | std::ios::out);
+        const unsigned char location[4]{0x7F, 0x00, 0x00, 0x01};
+        stream.seekp(1 * sizeof(uint32_t));
+        stream.write(reinterpret_cast<const char*>(location), sizeof(location));
+    }
+
+    using FileAccess = anvil::Region::FileAccess;
+    for(auto access : {FileAccess::Stream, FileAccess::MemoryMapped}) {
+        anvil::Region region;
+        region.setLazyLoading(true);
+        ASSERT_NO_THROW(region.loadFromFile(filename, access));
+        EXPECT_FALSE(region.isChunkLoadable(1));
+        EXPECT_TRUE(region.chunkAt(1).empty());
+        EXPECT_EQ(region.chunkAt(0).xPos(), 0);
+        EXPECT_EQ(region.chunkAt(2).xPos(), 2);
+    }
+
+    // Saving clears the invalid entry in the file.
+    {
+        anvil::Region region;
+        region.loadFromFile(filename);
+        region.chunkAt(0).rootTag()->getChildByName("yPos")->asIntTag()->setValue(1);
+        ASSERT_TRUE(region.saveChanges());
+    }
+    std::ifstream stream(filename, std::ios::binary);
+    unsigned char location[4]{0xFF, 0xFF, 0xFF, 0xFF};
+    stream.seekg(1 * sizeof(uint32_t));
+    stream.read(reinterpret_cast<char*>(location), sizeof(location));
+    EXPECT_EQ(location[0] | location[1] | location[2] | location[3], 0);
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename);
+    EXPECT_EQ(reloaded.chunkAt(0).yPos(), 1);
+    EXPECT_EQ(reloaded.chunkAt(2).xPos(), 2);
+}
+
+TEST(Region, for_each_chunk)
+{
+    const std::vector<size_t> indices{0, 40, 41, 500, 999};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.setLazyLoading(true);
+    region.loadFromFile(filename);
+    EXPECT_EQ(region.chunkAt(500).xPos(), 20);
+
+    // The small chunks fit into a single batch, independent of the thread count.
+    std::vector<size_t> visited;
+    size_t maxLoaded = 0;
+    region.forEachChunk(
+        [&](size_t index, const anvil::Chunk& chunk) {
+            EXPECT_EQ(static_cast<size_t>(chunk.xPos()), index % 32);
+            maxLoaded = std::max(maxLoaded, region.loadedChunkCount());
+            visited.push_back(index);
+        },
+        2);
+
+    std::sort(visited.begin(), visited.end());
+    EXPECT_EQ(visited, indices);
+    EXPECT_EQ(maxLoaded, indices.size());
+    EXPECT_EQ(region.loadedChunkCount(), 1u);
+    EXPECT_TRUE(region.isChunkLoaded(500));
+}
+
+TEST(Region, for_each_chunk_sector_budget)
+{
+    // Chunks of about 100 sectors each, a batch holds two of them.
+    const std::vector<size_t> indices{0, 1, 2, 3, 4};
+    const std::string filename = test::writeTestRegion(indices);
+    {
+        anvil::Region region;
+        region.loadFromFile(filename);
+        for(size_t index : indices) {
+            std::vector<anvil::ByteType> noise(100 * anvil::Region::SectorSize);
+            uint32_t state = static_cast<uint32_t>(index) + 1;
+            for(anvil::ByteType& value : noise) {
+                state = state * 1664525u + 1013904223u;
+                value = static_cast<anvil::ByteType>(state >> 24);
+            }
+            region.chunkAt(index).rootTag()->push_back(
+                std::make_unique<anvil::ByteArrayTag>("noise", noise));
+            region.markChunkDirty(index);
+        }
+        ASSERT_TRUE(region.saveChanges());
+    }
+
+    anvil::Region region;
+    region.loadPartiallyFromFile(filename);
+    size_t visited = 0;
+    region.forEachChunk(
+        [&](size_t, const anvil::Chunk&) {
+            EXPECT_LE(region.loadedChunkCount(), 2u);
+            ++visited;
+        },
+        8);
+    EXPECT_EQ(visited, indices.size());
+    EXPECT_EQ(region.loadedChunkCount(), 0u);
+}
+
+TEST(Region, lz4_compression)
+{
+    if(!anvil::isLz4Supported()) {
+        GTEST_SKIP() << "Built without LZ4 support.";
+    }
+
+    const std::vector<size_t> indices{0, 40, 999};
+    const std::string filename = test::writeTestRegion(indices);
+
+    anvil::Region region;
+    region.setLazyLoading(true);
+    region.loadFromFile(filename);
+    region.setChunkCompression(40, anvil::CompressionType::Lz4);
+    EXPECT_TRUE(region.isChunkLoaded(40));
+    EXPECT_TRUE(region.hasUnsavedChanges());
+    ASSERT_TRUE(region.saveChanges());
+
+    anvil::Region reloaded;
+    reloaded.loadFromFile(filename);
+    EXPECT_EQ(reloaded.rawChunkCompression(40), anvil::CompressionType::Lz4);
+    EXPECT_EQ(reloaded.chunkCompression(0), anvil::CompressionType::Uncompressed);
+    EXPECT_EQ(reloaded.chunkAt(40).xPos(), 8);
+    EXPECT_EQ(reloaded.chunkAt(999).xPos(), 7);
+    EXPECT_THROW(reloaded.setChunkCompression(0, static_cast<anvil::CompressionType>(127)),
+                 std::runtime_error);
+}
+
+TEST(Region, load_chunks_subset)
+{
+    const std::string filename = test::writeTestRegion({0, 1, 2, 3, 4, 200, 201, 600});
+
+    // Move chunk 1 to the end of the file, so that the file order differs from the index order.
+    {
+        anvil::Region region;
+        region.loadFromFile(filename);
+        std::vector<anvil::ByteType> noise(12000);
+        for(size_t i = 0; i < noise.size(); ++i) {
+            noise[i] = static_cast<anvil::ByteType>((i * 7919u) >> 5);
+        }
+        region.chunkAt(1).rootTag()->push_back(std::make_unique<anvil::ByteArrayTag>("n", noise));
+        region.markChunkDirty(1);
+        ASSERT_TRUE(region.saveChanges());
+    }
+
+    anvil::Region full;
+    full.loadFromFile(filename);
+
+    using FileAccess = anvil::Region::FileAccess;
+    for(auto access : {FileAccess::Stream, FileAccess::MemoryMapped}) {
+        anvil::Region region;
+        region.loadPartiallyFromFile(filename, access);
+        region.loadChunkAt(3);
+        region.loadChunks({600, 1, 2, 3, 1, 200, 4, 5}, 2);
+
+        for(size_t index : {1, 2, 3, 4, 200, 600}) {
+            ASSERT_TRUE(region.isChunkLoaded(index));
+            EXPECT_EQ(*region.chunkAt(index).rootTag(), *full.chunkAt(index).rootTag());
+        }
+        EXPECT_FALSE(region.isChunkLoaded(0));
+        EXPECT_FALSE(region.isChunkLoaded(201));
+        EXPECT_FALSE(region.isChunkLoaded(5));
+        EXPECT_THROW(region.loadChunks({anvil::Region::Chunks}), std::out_of_range);
+    }
+}
+
+TEST(Region, compact)
+{
+    const std::vector<size_t> indices{0, 1, 2, 33, 64, 500};
+    const std::string filename = test::writeTestRegion(indices);
+
+    // Grow chunk 1 twice, its old sectors are left unused.
+    for(size_t size : {9000u, 20000u}) {
+        anvil::Region region;
+        region.loadFromFile(filename);
+        std::vector<anvil::ByteType> noise(size);
+        for(size_t i = 0; i < noise.size(); ++i) {
+            noise[i] = static_cast<anvil::ByteType>((i * 7919u) >> 3);
+        }
+        region.chunkAt(1).rootTag()->push_back(std::make_unique<anvil::ByteArrayTag>("n", noise));
+        region.markChunkDirty(1);
+        ASSERT_TRUE(region.saveChanges());
+    }
+
+    anvil::Region original;
+    original.loadFromFile(filename);
+
+    std::filesystem::path dir = std::filesystem::path(filename).parent_path();
+    const std::string compactedFilename = (dir / "r.3.0.mca").string();
+    auto result = anvil::Region::compactFile(filename, compactedFilename,
+                                             anvil::Region::ChunkOrder::Morton);
+    EXPECT_EQ(result.originalSize, std::filesystem::file_size(filename));
+    EXPECT_EQ(result.compactedSize, std::filesystem::file_size(compactedFilename));
+    EXPECT_GT(result.reclaimedBytes(), 0u);
+
+    anvil::Region compacted;
+    compacted.loadFromFile(compactedFilename);
+    for(size_t index : indices) {
+        EXPECT_EQ(*compacted.chunkAt(index).rootTag(), *original.chunkAt(index).rootTag());
+    }
+    EXPECT_THROW(anvil::Region::compactFile(filename, filename), std::runtime_error);
+
+    // In place compaction of a mapped region, nothing left to reclaim afterwards.
+    anvil::Region region;
+    region.loadPartiallyFromFile(filename, anvil::Region::FileAccess::MemoryMapped);
+    EXPECT_GT(region.compact().reclaimedBytes(), 0u);
+    region.loadAllChunks();
+    EXPECT_EQ(*region.chunkAt(33).rootTag(), *original.chunkAt(33).rootTag());
+    EXPECT_EQ(region.compact().reclaimedBytes(), 0u);
+}
+
+TEST(Region, compact_failure)
+{
+    const std::string filename = test::writeTestRegion({0, 1});
+
+    // Corrupt the length prefix of chunk 1, the header itself stays valid.
+    {
+        std::fstream stream(filename, std::ios::binary | std::ios::in | std::ios::out);
+        unsigned char location[3] = {};
+        stream.seekg(4);
+        stream.read(reinterpret_cast<char*>(location), sizeof(location));
+        const size_t offset = (location[0] << 16 | location[1] << 8 | location[2]) * 4096u;
+        const char length[4] = {'\x7f', '\x7f', '\x7f', '\x7f'};
+        stream.seekp(static_cast<std::streamoff>(offset));
+        stream.write(length, sizeof(length));
+    }
+    const auto fileSize = std::filesystem::file_size(filename);
+
+    anvil::Region region;
+    region.loadPartiallyFromFile(filename);
+    EXPECT_THROW(region.compact(), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(filename + ".compact"));
+    EXPECT_EQ(std::filesystem::file_size(filename), fileSize);
+    region.loadChunkAt(0);
+    EXPECT_EQ(region.chunkAt(0).xPos(), 0);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/anvil.hpp>
+#include <cpp-anvil/nbt.hpp>
+
+#include <filesystem>
+
+#include "test_region_data.hpp"
+
+TEST(World, chunkWorld2Region)
+{
+    EXPECT_EQ(anvil::chunkWorld2Region({0, 31}).x, 0);
+    EXPECT_EQ(anvil::chunkWorld2Region({0, 31}).z, 0);
+    EXPECT_EQ(anvil::chunkWorld2Region({32, -1}).x, 1);
+    EXPECT_EQ(anvil::chunkWorld2Region({32, -1}).z, -1);
+    EXPECT_EQ(anvil::chunkWorld2Region({-32, -33}).x, -1);
+    EXPECT_EQ(anvil::chunkWorld2Region({-32, -33}).z, -2);
+}
+
+TEST(World, regionKey)
+{
+    EXPECT_EQ(anvil::regionKey({0, 0}), 0u);
+    EXPECT_NE(anvil::regionKey({1, 0}), anvil::regionKey({0, 1}));
+    EXPECT_NE(anvil::regionKey({-1, 0}), anvil::regionKey({0, -1}));
+    EXPECT_NE(anvil::regionKey({-1, -1}), anvil::regionKey({-1, 0}));
+}
+
+TEST(World, chunk_access_and_eviction)
+{
+    const std::string directory = test::createTestWorld();
+
+    anvil::World world(directory, 0);
+    EXPECT_EQ(world.regionCoordinates().size(), 3u);
+
+    const anvil::World& constWorld = world;
+    EXPECT_EQ(constWorld.chunkAt({-32, 0}).xPos(), -32);
+    EXPECT_EQ(constWorld.chunkAt({9, 0}).xPos(), 9);
+    EXPECT_EQ(constWorld.chunkAt({27, -32}).zPos(), -32);
+
+    // Without budget only the last used region is kept.
+    EXPECT_EQ(world.cachedRegionCount(), 1u);
+    EXPECT_TRUE(world.isRegionCached({0, -1}));
+
+    // Modified regions are kept until they are saved.
+    world.chunkAt({18, 0}).rootTag()->getChildByName("zPos")->asIntTag()->setValue(77);
+    world.markChunkDirty({18, 0});
+    world.chunkAt({40, 40}).setRootTag(test::makeChunkTag({40, 40}, 4096));
+    world.markChunkDirty({40, 40});
+    EXPECT_EQ(constWorld.chunkAt({-32, 0}).xPos(), -32);
+    EXPECT_TRUE(world.isRegionCached({0, 0}));
+    EXPECT_TRUE(world.isRegionCached({1, 1}));
+    EXPECT_GT(world.memoryUsage(), 0u);
+
+    // Unmodified chunks of modified regions are unloaded.
+    EXPECT_EQ(constWorld.chunkAt({27, 0}).xPos(), 27);
+    EXPECT_EQ(constWorld.chunkAt({-32, 0}).xPos(), -32);
+    EXPECT_FALSE(world.regionAt({0, 0}).isChunkLoaded(27));
+    EXPECT_TRUE(world.regionAt({0, 0}).isChunkLoaded(18));
+
+    ASSERT_TRUE(world.saveAll());
+    EXPECT_TRUE(std::filesystem::exists(world.regionFilename({1, 1})));
+    world.setMemoryBudget(0);
+    EXPECT_EQ(world.cachedRegionCount(), 0u);
+
+    anvil::World reloaded(directory);
+    EXPECT_EQ(reloaded.chunkAt({18, 0}).zPos(), 77);
+    EXPECT_EQ(reloaded.chunkAt({40, 40}).xPos(), 40);
+    EXPECT_EQ(reloaded.regionCoordinates().size(), 4u);
+    EXPECT_TRUE(reloaded.chunkAt({1, 0}).empty());
+}
+
+TEST(World, non_const_reads_are_evicted)
+{
+    const std::string directory = test::createTestWorld();
+
+    // Reading chunks through the non-const interface must not keep their regions alive.
+    anvil::World world(directory, 0);
+    for(anvil::Vec2 regionCoord : world.regionCoordinates()) {
+        for(size_t index = 0; index < anvil::Region::Chunks; index += 9) {
+            const anvil::Vec2 chunkCoord =
+                anvil::chunkRegion2ChunkWorld(anvil::Region::fromIndex(index), regionCoord);
+            ASSERT_EQ(world.chunkAt(chunkCoord).xPos(), chunkCoord.x);
+            EXPECT_EQ(world.cachedRegionCount(), 1u);
+        }
+    }
+    EXPECT_FALSE(world.regionAt({0, 0}).hasUnsavedChanges());
+
+    // Marked changes are measured again.
+    anvil::Chunk& chunk      = world.chunkAt({9, 0});
+    const size_t usage       = world.memoryUsage();
+    anvil::CompoundTag* root = chunk.rootTag();
+    root->push_back(std::make_unique<anvil::LongArrayTag>(
+        "more", std::vector<anvil::LongType>(4096, 1)));
+    world.markChunkDirty({9, 0});
+    EXPECT_GE(world.memoryUsage(), usage + 4096 * sizeof(anvil::LongType));
+}
+
+TEST(World, unmarked_changes_are_kept)
+{
+    const std::string directory = test::createTestWorld();
+    {
+        anvil::World world(directory, 0);
+        const anvil::World& constWorld = world;
+        world.chunkAt({9, 0}).rootTag()->getChildByName("zPos")->asIntTag()->setValue(55);
+
+        // The changed region is not closed when another region is opened.
+        EXPECT_EQ(constWorld.chunkAt({-32, 0}).xPos(), -32);
+        EXPECT_TRUE(world.isRegionCached({0, 0}));
+        EXPECT_TRUE(world.regionAt({0, 0}).hasUnsavedChanges());
+        ASSERT_TRUE(world.saveAll());
+    }
+
+    anvil::World reloaded(directory);
+    EXPECT_EQ(reloaded.chunkAt({9, 0}).zPos(), 55);
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/anvil.hpp>
+#include <cpp-anvil/nbt.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "test_region_data.hpp"
+
+TEST(WorldIndex, scan)
+{
+    const std::string directory = test::createTestWorld();
+    {
+        anvil::World world(directory);
+        world.chunkAt({-4, 0}).setRootTag(test::makeChunkTag({-4, 0}, 4096));
+        world.markChunkDirty({-4, 0});
+        ASSERT_TRUE(world.saveAll());
+    }
+    std::ofstream((std::filesystem::path(directory) / "region" / "r.5.5.mca").string()) << "x";
+
+    anvil::WorldIndex index = anvil::WorldIndex::scan(directory, 2);
+    EXPECT_EQ(index.regionCount(), 3u);
+    EXPECT_EQ(index.skippedRegionCount(), 1u);
+    EXPECT_EQ(index.chunkCount(), 3u * 114u + 1u);
+
+    EXPECT_TRUE(index.contains({9, 0}));
+    EXPECT_FALSE(index.contains({10, 0}));
+    EXPECT_TRUE(index.contains({-32, 0}));
+    EXPECT_TRUE(index.contains({-4, 0}));
+    EXPECT_FALSE(index.contains({100, 100}));
+    EXPECT_EQ(index.sectorCount({9, 0}), 9u);
+    EXPECT_EQ(index.sectorCount({10, 0}), 0u);
+    EXPECT_EQ(index.timestamp({9, 0}), 0u);
+    EXPECT_GT(index.timestamp({-4, 0}), 0u);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/nbt.hpp>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+std::unique_ptr<anvil::CompoundTag> createCompound(int count)
+{
+    auto compound = std::make_unique<anvil::CompoundTag>("compound");
+    for(int i = 0; i < count; ++i) {
+        compound->push_back(std::make_unique<anvil::IntTag>("child" + std::to_string(i), i));
+    }
+    return compound;
+}
+
+int childValue(const anvil::CompoundTag& compound, const std::string& name)
+{
+    const anvil::BasicTag* child = compound.getChildByName(name);
+    return child != nullptr ? child->asIntTag()->value() : -1;
+}
+
+} // namespace
+
+TEST(CompoundTag, index)
+{
+    // The index is built as soon as the compound has enough children
+    auto compound = createCompound(anvil::CompoundTag::IndexThreshold - 1);
+    EXPECT_FALSE(compound->isIndexed());
+    compound = createCompound(32);
+    EXPECT_TRUE(compound->isIndexed());
+    EXPECT_NE(compound->getChildByName("child31"), nullptr);
+
+    // push_back
+    compound->push_back(std::make_unique<anvil::IntTag>("added", 100));
+    EXPECT_EQ(childValue(*compound, "added"), 100);
+
+    // takeAt, take and erase shift the following children
+    auto taken = compound->takeAt(0);
+    EXPECT_EQ(taken->name(), "child0");
+    EXPECT_EQ(childValue(*compound, "child0"), -1);
+    EXPECT_EQ(childValue(*compound, "child1"), 1);
+    EXPECT_NE(compound->take(compound->getChildByName("child10")), nullptr);
+    EXPECT_TRUE(compound->erase(compound->getChildByName("child20")));
+    for(int i = 1; i < 32; ++i) {
+        const std::string name = "child" + std::to_string(i);
+        EXPECT_EQ(childValue(*compound, name), (i == 10 || i == 20) ? -1 : i) << name;
+    }
+    EXPECT_EQ(childValue(*compound, "added"), 100);
+
+    // eraseAt from the base class is hidden and updates the index as well
+    EXPECT_TRUE(compound->eraseAt(0));
+    EXPECT_EQ(childValue(*compound, "child1"), -1);
+    EXPECT_EQ(childValue(*compound, "child2"), 2);
+    EXPECT_FALSE(compound->eraseAt(compound->size()));
+    EXPECT_EQ(compound->takeAt(compound->size()), nullptr);
+
+    // Children keep their insertion order
+    EXPECT_EQ(compound->front()->name(), "child2");
+    EXPECT_EQ(compound->back()->name(), "added");
+}
+
+TEST(CompoundTag, index_changed_children)
+{
+    auto compound = createCompound(16);
+    compound->buildIndex();
+
+    compound->getChildByName("child3")->setName("renamed");
+    EXPECT_EQ(childValue(*compound, "child3"), -1);
+    EXPECT_EQ(childValue(*compound, "renamed"), 3);
+
+    compound->swap(0, 15);
+    EXPECT_EQ(childValue(*compound, "child0"), 0);
+    EXPECT_EQ(childValue(*compound, "child15"), 15);
+
+    compound->clear();
+    EXPECT_FALSE(compound->isIndexed());
+    EXPECT_EQ(compound->getChildByName("child1"), nullptr);
+
+    anvil::ContainerType<std::unique_ptr<anvil::BasicTag>> children;
+    for(int i = 0; i < 10; ++i) {
+        children.push_back(std::make_unique<anvil::IntTag>("value" + std::to_string(i), i));
+    }
+    compound->setValue(children);
+    EXPECT_TRUE(compound->isIndexed());
+    EXPECT_EQ(childValue(*compound, "value9"), 9);
+}
+
+TEST(CompoundTag, index_read_data)
+{
+    auto compound = createCompound(16);
+    compound->push_back(std::make_unique<anvil::IntTag>("child5", 50));
+
+    std::vector<unsigned char> data = anvil::writeData(compound.get());
+    auto read                       = anvil::readData(data);
+    ASSERT_TRUE(read->isIndexed());
+
+    // The first child of duplicate names is found
+    EXPECT_EQ(childValue(*read, "child5"), 5);
+    EXPECT_EQ(*read, *compound);
+}
+
+TEST(CompoundTag, index_follows_renames)
+{
+    auto compound = createCompound(16);
+    ASSERT_TRUE(compound->isIndexed());
+
+    // A renamed child is found by its new name only, also if that name is a duplicate.
+    compound->getChildByName("child3")->setName("child4");
+    EXPECT_EQ(childValue(*compound, "child3"), -1);
+    EXPECT_EQ(childValue(*compound, "child4"), 3);
+    compound->at(4)->setName("other");
+    EXPECT_EQ(childValue(*compound, "child4"), 3);
+    EXPECT_EQ(childValue(*compound, "other"), 4);
+
+    // Children that left the compound do not change its index.
+    auto taken = compound->takeAt(0);
+    taken->setName("child1");
+    EXPECT_EQ(childValue(*compound, "child1"), 1);
+    EXPECT_EQ(childValue(*compound, "child0"), -1);
+
+    auto replaced = compound->replaceAt(4, std::make_unique<anvil::IntTag>("child7", 70));
+    ASSERT_NE(replaced, nullptr);
+    EXPECT_EQ(replaced->name(), "child5");
+    EXPECT_EQ(childValue(*compound, "child5"), -1);
+    EXPECT_EQ(childValue(*compound, "child7"), 70);
+    EXPECT_TRUE(compound->erase(compound->at(4).get()));
+    EXPECT_EQ(childValue(*compound, "child7"), 7);
+    EXPECT_EQ(compound->replaceAt(compound->size(), std::make_unique<anvil::IntTag>("x", 0)),
+              nullptr);
+
+    // Copies and moved compounds index their own children.
+    anvil::CompoundTag copy(*compound);
+    copy.getChildByName("child8")->setName("copied");
+    EXPECT_EQ(childValue(*compound, "child8"), 8);
+    EXPECT_EQ(childValue(copy, "copied"), 8);
+
+    anvil::CompoundTag moved(std::move(copy));
+    moved.getChildByName("copied")->setName("moved");
+    EXPECT_EQ(childValue(moved, "moved"), 8);
+
+    anvil::CompoundTag assigned;
+    assigned = std::move(moved);
+    assigned.getChildByName("moved")->setName("assigned");
+    EXPECT_EQ(childValue(assigned, "assigned"), 8);
+    EXPECT_EQ(childValue(assigned, "moved"), -1);
+}
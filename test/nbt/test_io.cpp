@@ -2,6 +2,9 @@
 #include <gtest/gtest.h>
 
 #include <cpp-anvil/nbt/io.hpp>
+#include <cpp-anvil/util/compression.hpp>
+
+#include <filesystem>
 
 #include "test_data.hpp"
 
@@ -32,3 +35,24 @@ TEST(io, isNbtFile)
         R"(C:\Users\sonla\AppData\Roaming\.minecraft\saves\BOP_Terralith_Test\level.dat)";
     EXPECT_TRUE(anvil::isNbtFile(testFolder));
 }
+
+TEST(io, save_to_file_lz4)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    const std::string filename =
+        (std::filesystem::temp_directory_path() / "cpp-anvil-io-lz4.nbt").string();
+
+    EXPECT_FALSE(anvil::saveToFile(filename, data, static_cast<anvil::CompressionType>(127)));
+    if(!anvil::isLz4Supported()) {
+        EXPECT_FALSE(anvil::saveToFile(filename, data, anvil::CompressionType::Lz4));
+        GTEST_SKIP() << "Built without LZ4 support.";
+    }
+
+    ASSERT_TRUE(anvil::saveToFile(filename, data, anvil::CompressionType::Lz4));
+    anvil::CompressionType type = anvil::CompressionType::Uncompressed;
+    auto ctag                   = anvil::loadFromFile(filename, type);
+    ASSERT_TRUE(ctag != nullptr);
+    EXPECT_EQ(type, anvil::CompressionType::Lz4);
+    EXPECT_EQ(anvil::writeData(ctag.get()), data);
+}
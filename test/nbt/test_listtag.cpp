@@ -2,6 +2,8 @@
 
 #include <cpp-anvil/nbt.hpp>
 
+#include "test_data.hpp"
+
 TEST(ListTag, Constructor)
 {
     anvil::ListTag listTag;
@@ -165,3 +167,129 @@ TEST(ListTag, iterator_for)
         EXPECT_TRUE((*it)->isByteTag());
     }
 }
+
+TEST(ListTag, pack)
+{
+    anvil::ListTag listTag;
+    listTag.push_back(anvil::IntTag(10));
+    listTag.push_back(anvil::IntTag(20));
+    EXPECT_FALSE(listTag.isPacked());
+
+    EXPECT_TRUE(listTag.pack());
+    EXPECT_TRUE(listTag.isPacked());
+    EXPECT_EQ(listTag.size(), 2);
+    ASSERT_EQ(listTag.values<anvil::IntType>().size(), 2);
+    EXPECT_EQ(listTag.values<anvil::IntType>()[1], 20);
+    EXPECT_THROW(listTag.values<anvil::LongType>(), std::runtime_error);
+
+    // Appending a tag keeps the list packed
+    EXPECT_TRUE(listTag.push_back(anvil::IntTag(30)));
+    EXPECT_FALSE(listTag.push_back(anvil::ByteTag(0x01)));
+    EXPECT_TRUE(listTag.isPacked());
+    EXPECT_EQ(listTag.values<anvil::IntType>()[2], 30);
+
+    // The tag interface requires an unpacked list
+    const anvil::ListTag& constTag = listTag;
+    EXPECT_THROW(constTag.at(2), std::runtime_error);
+    EXPECT_THROW(listTag.begin(), std::runtime_error);
+    EXPECT_TRUE(listTag.isPacked());
+    listTag.unpack();
+    EXPECT_FALSE(listTag.isPacked());
+    EXPECT_EQ(listTag.size(), 3);
+    EXPECT_EQ(listTag.at(0)->asIntTag()->value(), 10);
+    EXPECT_EQ(constTag.at(2)->asIntTag()->value(), 30);
+    EXPECT_THROW(listTag.values<anvil::IntType>(), std::runtime_error);
+
+    anvil::ListTag stringList;
+    stringList.push_back(anvil::StringTag("Value"));
+    EXPECT_FALSE(stringList.pack());
+}
+
+TEST(ListTag, values)
+{
+    const std::vector<anvil::DoubleType> values = {1.5, -2.0, 3.25};
+
+    anvil::ListTag listTag("List");
+    listTag.setValues<anvil::DoubleType>(values);
+    EXPECT_EQ(listTag.listType(), anvil::TagType::Double);
+    EXPECT_EQ(listTag.size(), 3);
+
+    listTag.values<anvil::DoubleType>()[0] = 4.5;
+    EXPECT_TRUE(listTag.appendValue<anvil::DoubleType>(5.0));
+    EXPECT_FALSE(listTag.appendValue<anvil::FloatType>(5.0f));
+    EXPECT_TRUE(listTag.eraseAt(1));
+
+    const anvil::ListTag copy(listTag);
+    EXPECT_EQ(copy, listTag);
+    ASSERT_EQ(copy.values<anvil::DoubleType>().size(), 3);
+    EXPECT_EQ(copy.values<anvil::DoubleType>()[0], 4.5);
+    EXPECT_EQ(copy.values<anvil::DoubleType>()[1], 3.25);
+    EXPECT_EQ(copy.values<anvil::DoubleType>()[2], 5.0);
+
+    anvil::ListTag emptyList;
+    EXPECT_TRUE(emptyList.appendValue<anvil::ShortType>(7));
+    EXPECT_EQ(emptyList.listType(), anvil::TagType::Short);
+}
+
+TEST(ListTag, equal_packed_and_unpacked)
+{
+    anvil::ListTag tags("List");
+    tags.push_back(anvil::IntTag(1));
+    tags.push_back(anvil::IntTag(2));
+    tags.push_back(anvil::IntTag(3));
+
+    anvil::ListTag packed(tags);
+    ASSERT_TRUE(packed.pack());
+    EXPECT_EQ(packed.size(), 3);
+    EXPECT_EQ(packed, tags);
+    EXPECT_EQ(tags, packed);
+
+    packed.values<anvil::IntType>()[2] = 4;
+    EXPECT_NE(packed, tags);
+    EXPECT_NE(tags, packed);
+
+    anvil::ListTag other(tags);
+    other.at(0)->asIntTag()->setValue(5);
+    EXPECT_NE(other, tags);
+}
+
+TEST(ListTag, read_write_packed)
+{
+    anvil::CompoundTag root("Root");
+    auto listTag = std::make_unique<anvil::ListTag>("Longs");
+    listTag->push_back(anvil::LongTag(1));
+    listTag->push_back(anvil::LongTag(-2));
+    root.push_back(std::move(listTag));
+
+    std::vector<unsigned char> data = anvil::writeData(&root);
+    anvil::ReadOptions options;
+    options.packLists = true;
+    auto result       = anvil::readData(data, options);
+    ASSERT_TRUE(result);
+
+    auto* readList = result->getChildByName("Longs")->asListTag();
+    ASSERT_TRUE(readList->isPacked());
+    ASSERT_EQ(readList->values<anvil::LongType>().size(), 2);
+    EXPECT_EQ(readList->values<anvil::LongType>()[1], -2);
+
+    EXPECT_EQ(anvil::writeData(result.get()), data);
+}
+
+TEST(ListTag, read_tags_by_default)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+    auto root = anvil::readData(data);
+    ASSERT_TRUE(root);
+
+    // Numeric lists keep working with the tag interface.
+    const anvil::ListTag* listTag = root->getChildByName("listTest (long)")->asListTag();
+    ASSERT_NE(listTag, nullptr);
+    EXPECT_FALSE(listTag->isPacked());
+    EXPECT_EQ(listTag->at(0)->asLongTag()->value(), 11);
+
+    std::vector<anvil::LongType> values;
+    for(const auto& tag : *listTag) {
+        values.push_back(tag->asLongTag()->value());
+    }
+    EXPECT_EQ(values, (std::vector<anvil::LongType>{11, 12, 13, 14, 15}));
+}
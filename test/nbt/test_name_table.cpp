@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/nbt.hpp>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(NameTable, intern)
+{
+    const anvil::StringType* name = anvil::detail::internName("interned name");
+    EXPECT_EQ(*name, "interned name");
+    EXPECT_EQ(anvil::detail::internName(std::string("interned ") + "name"), name);
+    EXPECT_EQ(anvil::detail::findName("interned name"), name);
+    EXPECT_EQ(anvil::detail::findName("never interned name"), nullptr);
+    EXPECT_EQ(anvil::detail::internName(""), anvil::detail::emptyName());
+
+    {
+        anvil::detail::NameCache cache;
+        EXPECT_EQ(cache.intern("interned name"), name);
+        EXPECT_EQ(cache.intern("interned name"), name);
+        EXPECT_EQ(*cache.intern("other name"), "other name");
+    }
+
+    // Every internName() returned a reference
+    anvil::detail::releaseName(name);
+    anvil::detail::releaseName(name);
+    EXPECT_EQ(anvil::detail::findName("interned name"), nullptr);
+}
+
+TEST(NameTable, tag_names)
+{
+    const anvil::IntTag a("shared", 1);
+    anvil::IntTag b("shared", 2);
+    const anvil::IntTag& constB = b;
+    EXPECT_EQ(&a.name(), &constB.name());
+
+    b.setName("renamed");
+    EXPECT_EQ(b.name(), "renamed");
+    EXPECT_NE(&a.name(), &constB.name());
+
+    anvil::CompoundTag compound("compound");
+    compound.push_back(std::make_unique<anvil::IntTag>("first", 1));
+    compound.push_back(std::make_unique<anvil::IntTag>("second", 2));
+    ASSERT_NE(compound.getChildByName("second"), nullptr);
+    EXPECT_EQ(compound.getChildByName("second")->asIntTag()->value(), 2);
+    EXPECT_TRUE(compound.hasChild("first"));
+    EXPECT_FALSE(compound.hasChild("third"));
+    EXPECT_EQ(compound.getChildByName("never used as a tag name"), nullptr);
+}
+
+TEST(NameTable, release)
+{
+    const size_t count = anvil::detail::internedNameCount();
+    {
+        anvil::IntTag tag("released name", 1);
+        anvil::IntTag copy(tag);
+        EXPECT_EQ(anvil::detail::internedNameCount(), count + 1);
+
+        tag.setName("other released name");
+        EXPECT_EQ(anvil::detail::internedNameCount(), count + 2);
+        EXPECT_NE(anvil::detail::findName("released name"), nullptr);
+
+        copy = tag;
+        EXPECT_EQ(anvil::detail::internedNameCount(), count + 1);
+        EXPECT_EQ(anvil::detail::findName("released name"), nullptr);
+    }
+    EXPECT_EQ(anvil::detail::internedNameCount(), count);
+    EXPECT_EQ(anvil::detail::findName("other released name"), nullptr);
+
+    // The cache keeps its names until it is destroyed.
+    {
+        anvil::detail::NameCache cache;
+        const anvil::StringType* name = cache.intern("cached name");
+        EXPECT_EQ(anvil::detail::findName("cached name"), name);
+
+        anvil::IntTag tag;
+        tag.setInternedName(name);
+        EXPECT_EQ(&std::as_const(tag).name(), name);
+    }
+    EXPECT_EQ(anvil::detail::internedNameCount(), count);
+}
+
+TEST(NameTable, concurrent_intern)
+{
+    const size_t count = anvil::detail::internedNameCount();
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            for(int i = 0; i < 2000; ++i) {
+                auto tag = std::make_unique<anvil::IntTag>("name" + std::to_string(i % 7), i);
+                tag->setName("renamed" + std::to_string(i % 5));
+                auto copy = tag->clone();
+                EXPECT_EQ(copy->name(), "renamed" + std::to_string(i % 5));
+            }
+        });
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(anvil::detail::internedNameCount(), count);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/nbt.hpp>
+
+#include "test_data.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+class CountingHandler : public anvil::NbtHandler
+{
+public:
+    void beginCompound(std::string_view) override { ++compounds; }
+    void beginList(std::string_view name, anvil::TagType, size_t size) override
+    {
+        if(name == "listTest (long)") {
+            listSize = size;
+        }
+    }
+    void value(std::string_view name, anvil::IntType value) override
+    {
+        if(name == "intTest") {
+            intTest = value;
+        }
+    }
+    void value(std::string_view name, anvil::LongType value) override
+    {
+        // Elements of lists do not have names
+        if(name.empty()) {
+            listSum += value;
+        }
+    }
+    void value(std::string_view name, std::string_view value) override
+    {
+        if(name == "name") {
+            names.emplace_back(value);
+        }
+    }
+    void array(std::string_view, std::span<const anvil::ByteType> values) override
+    {
+        byteArraySize = values.size();
+    }
+
+    int compounds{0};
+    size_t listSize{0};
+    int32_t intTest{0};
+    int64_t listSum{0};
+    size_t byteArraySize{0};
+    std::vector<std::string> names;
+};
+
+} // namespace
+
+TEST(parser, events)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    CountingHandler handler;
+    anvil::parseData(data, handler);
+
+    // Root, nested compound test, ham, egg and the two compounds of listTest (compound)
+    EXPECT_EQ(handler.compounds, 6);
+    EXPECT_EQ(handler.listSize, 5);
+    EXPECT_EQ(handler.intTest, 2147483647);
+    EXPECT_EQ(handler.listSum, 11 + 12 + 13 + 14 + 15);
+    EXPECT_EQ(handler.byteArraySize, 1000);
+    EXPECT_EQ(handler.names.size(), 4);
+}
+
+TEST(parser, invalid_data)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    anvil::NbtHandler handler;
+
+    data.resize(200);
+    EXPECT_THROW(anvil::parseData(data, handler), std::runtime_error);
+
+    data[0] = static_cast<unsigned char>(anvil::TagType::Int);
+    EXPECT_THROW(anvil::parseData(data, handler), std::runtime_error);
+}
+
+TEST(parser, arrays)
+{
+    // Sizes that are not a multiple of the vector width test the scalar remainder as well.
+    anvil::CompoundTag root("Root");
+    for(int32_t size : {0, 1, 3, 37, 1027}) {
+        auto intArray  = std::make_unique<anvil::IntArrayTag>();
+        auto longArray = std::make_unique<anvil::LongArrayTag>();
+        for(int32_t i = 0; i < size; ++i) {
+            intArray->push_back(static_cast<int32_t>(i * 0x01020304u - 7u));
+            longArray->push_back(static_cast<int64_t>(i * 0x0102030405060708u + 9u));
+        }
+        intArray->setName("Ints " + std::to_string(size));
+        longArray->setName("Longs " + std::to_string(size));
+        root.push_back(std::move(intArray));
+        root.push_back(std::move(longArray));
+    }
+
+    std::vector<unsigned char> data = anvil::writeData(&root);
+    auto result = anvil::readData(data);
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, root);
+    for(const auto& tag : root) {
+        const auto* child = result->getChildByName(tag->name());
+        ASSERT_NE(child, nullptr);
+        if(tag->isIntArrayTag()) {
+            EXPECT_EQ(child->asIntArrayTag()->value(), tag->asIntArrayTag()->value());
+        } else {
+            EXPECT_EQ(child->asLongArrayTag()->value(), tag->asLongArrayTag()->value());
+        }
+    }
+
+    data.resize(data.size() - 20);
+    EXPECT_THROW(anvil::readData(data), std::runtime_error);
+}
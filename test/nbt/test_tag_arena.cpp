@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/nbt.hpp>
+
+#include "test_data.hpp"
+
+#include <memory>
+#include <vector>
+
+TEST(TagArena, make)
+{
+    auto heapTag = std::make_unique<anvil::IntTag>("heap", 1);
+    EXPECT_FALSE(anvil::TagArena::isArenaAllocated(heapTag.get()));
+    EXPECT_EQ(anvil::TagArena::blockOf(heapTag.get()), nullptr);
+
+    std::unique_ptr<anvil::IntTag> arenaTag;
+    {
+        anvil::TagArena arena;
+        arenaTag = arena.make<anvil::IntTag>("arena", 2);
+        auto tag = arena.make<anvil::IntTag>("arena", 3);
+        EXPECT_TRUE(anvil::TagArena::isArenaAllocated(tag.get()));
+        EXPECT_EQ(anvil::TagArena::blockOf(tag.get()), anvil::TagArena::blockOf(arenaTag.get()));
+        EXPECT_EQ(arena.reservedMemory(), anvil::TagArena::BlockSize);
+
+        // Copies are heap tags
+        auto copy = tag->clone();
+        EXPECT_FALSE(anvil::TagArena::isArenaAllocated(copy.get()));
+        EXPECT_EQ(*copy, *tag);
+    }
+
+    // Tags outlive their arena object
+    EXPECT_TRUE(anvil::TagArena::isArenaAllocated(arenaTag.get()));
+    EXPECT_EQ(arenaTag->name(), "arena");
+    EXPECT_EQ(arenaTag->value(), 2);
+}
+
+TEST(TagArena, blocks)
+{
+    anvil::TagArena arena;
+    std::vector<std::unique_ptr<anvil::IntTag>> tags;
+    const size_t count = 2 * anvil::TagArena::BlockSize / sizeof(anvil::IntTag);
+    for(size_t i = 0; i < count; ++i) {
+        tags.push_back(arena.make<anvil::IntTag>(static_cast<anvil::IntType>(i)));
+    }
+    EXPECT_GE(arena.reservedMemory(), 2 * anvil::TagArena::BlockSize);
+    EXPECT_NE(anvil::TagArena::blockOf(tags.front().get()),
+              anvil::TagArena::blockOf(tags.back().get()));
+
+    // A surviving tag keeps only its own block alive
+    auto survivor = std::move(tags.front());
+    tags.clear();
+    EXPECT_EQ(survivor->value(), 0);
+}
+
+TEST(TagArena, scope)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    std::unique_ptr<anvil::CompoundTag> outerRoot;
+    std::unique_ptr<anvil::CompoundTag> innerRoot;
+    {
+        anvil::TagArena arena;
+        anvil::TagArena::Scope scope(arena);
+        EXPECT_EQ(anvil::TagArena::current(), &arena);
+        {
+            anvil::TagArena inner;
+            anvil::TagArena::Scope innerScope(inner);
+            EXPECT_EQ(anvil::TagArena::current(), &inner);
+            innerRoot = anvil::readData(data);
+        }
+        EXPECT_EQ(anvil::TagArena::current(), &arena);
+        outerRoot = anvil::readData(data);
+
+        // Only readData() uses the arena of the scope
+        auto tag = std::make_unique<anvil::IntTag>("heap", 4);
+        EXPECT_FALSE(anvil::TagArena::isArenaAllocated(tag.get()));
+    }
+    EXPECT_EQ(anvil::TagArena::current(), nullptr);
+    EXPECT_TRUE(anvil::TagArena::isArenaAllocated(outerRoot.get()));
+    EXPECT_TRUE(anvil::TagArena::isArenaAllocated(innerRoot.get()));
+    EXPECT_NE(anvil::TagArena::blockOf(outerRoot.get()), anvil::TagArena::blockOf(innerRoot.get()));
+    EXPECT_EQ(*outerRoot, *innerRoot);
+
+    auto afterScope = anvil::readData(data);
+    EXPECT_FALSE(anvil::TagArena::isArenaAllocated(afterScope.get()));
+}
+
+TEST(TagArena, read_data)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    auto heapRoot = anvil::readData(data);
+
+    std::unique_ptr<anvil::CompoundTag> arenaRoot;
+    {
+        anvil::TagArena arena;
+        anvil::TagArena::Scope scope(arena);
+        arenaRoot = anvil::readData(data);
+    }
+    ASSERT_NE(arenaRoot, nullptr);
+    EXPECT_TRUE(anvil::TagArena::isArenaAllocated(arenaRoot.get()));
+    EXPECT_EQ(*arenaRoot, *heapRoot);
+
+    // Tags can be moved from arena trees to heap trees
+    auto child = arenaRoot->takeAt(0);
+    child->setName("moved");
+    const auto expected = child->clone();
+    heapRoot->push_back(std::move(child));
+    arenaRoot.reset();
+    ASSERT_TRUE(heapRoot->hasChild("moved"));
+    EXPECT_EQ(*heapRoot->getChildByName("moved"), *expected);
+}
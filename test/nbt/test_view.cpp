@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/nbt.hpp>
+
+#include "test_data.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+TEST(NbtView, bigtest)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    auto tag = anvil::readData(data);
+    ASSERT_NE(tag, nullptr);
+
+    anvil::NbtView root = anvil::viewData(data);
+    ASSERT_TRUE(root.isValid());
+    ASSERT_EQ(root.type(), anvil::TagType::Compound);
+
+    anvil::NbtCompoundView compound = root.asCompound();
+    EXPECT_EQ(compound.size(), tag->size());
+
+    EXPECT_EQ(compound["byteTest"].asByte(),
+              tag->getChildByName("byteTest")->asByteTag()->value());
+    EXPECT_EQ(compound["shortTest"].asShort(),
+              tag->getChildByName("shortTest")->asShortTag()->value());
+    EXPECT_EQ(compound["intTest"].asInt(), tag->getChildByName("intTest")->asIntTag()->value());
+    EXPECT_EQ(compound["longTest"].asLong(),
+              tag->getChildByName("longTest")->asLongTag()->value());
+    EXPECT_EQ(compound["floatTest"].asFloat(),
+              tag->getChildByName("floatTest")->asFloatTag()->value());
+    EXPECT_EQ(compound["doubleTest"].asDouble(),
+              tag->getChildByName("doubleTest")->asDoubleTag()->value());
+    EXPECT_EQ(compound["stringTest"].asString(),
+              tag->getChildByName("stringTest")->asStringTag()->value());
+
+    anvil::NbtCompoundView nested = compound["nested compound test"].asCompound();
+    EXPECT_EQ(nested["egg"].asCompound()["name"].asString(), "Eggbert");
+    EXPECT_EQ(nested["ham"].asCompound()["value"].asFloat(), 0.75f);
+
+    anvil::NbtListView longs = compound["listTest (long)"].asList();
+    ASSERT_EQ(longs.elementType(), anvil::TagType::Long);
+    ASSERT_EQ(longs.size(), 5);
+    EXPECT_EQ(longs[4].asLong(), 15);
+    int64_t expected = 11;
+    for(anvil::NbtView value : longs) {
+        EXPECT_EQ(value.asLong(), expected++);
+    }
+
+    anvil::NbtListView compounds = compound["listTest (compound)"].asList();
+    ASSERT_EQ(compounds.size(), 2);
+    EXPECT_EQ(compounds[1].asCompound()["name"].asString(), "Compound tag #1");
+    EXPECT_THROW(compounds[2], std::out_of_range);
+
+    const auto& bytes = tag->getChildByName(
+        "byteArrayTest (the first 1000 values of (n*n*255+n*7)%100, starting with n=0 (0, 62, 34, "
+        "16, 8, ...))");
+    ASSERT_NE(bytes, nullptr);
+    anvil::NbtArrayView<anvil::ByteType> byteView = compound[bytes->name()].asByteArray();
+    ASSERT_EQ(byteView.size(), bytes->asByteArrayTag()->value().size());
+    for(size_t i = 0; i < byteView.size(); ++i) {
+        EXPECT_EQ(byteView[i], bytes->asByteArrayTag()->value()[i]);
+    }
+}
+
+TEST(NbtView, invalid_access)
+{
+    std::vector<unsigned char> data(&bigtestUncompressedData[0],
+                                    &bigtestUncompressedData[0] + 1544);
+    anvil::NbtCompoundView compound = anvil::viewData(data).asCompound();
+
+    EXPECT_FALSE(compound.contains("missing"));
+    EXPECT_FALSE(compound["missing"]);
+    EXPECT_THROW(compound["missing"].asInt(), std::runtime_error);
+    EXPECT_THROW(compound["intTest"].asLong(), std::runtime_error);
+
+    data.resize(100);
+    compound = anvil::viewData(data).asCompound();
+    EXPECT_THROW(compound.find("doubleTest"), std::runtime_error);
+
+    data[0] = static_cast<unsigned char>(anvil::TagType::List);
+    EXPECT_THROW(anvil::viewData(data), std::runtime_error);
+}
@@ -1,8 +1,11 @@
 // gtest
 #include <gtest/gtest.h>
 
+#include "test_region_data.hpp"
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
+    ::testing::UnitTest::GetInstance()->listeners().Append(new test::TestDirectoryCleanup);
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,141 @@
+#ifndef CPP_ANVIL_TEST_REGION_DATA_HPP
+#define CPP_ANVIL_TEST_REGION_DATA_HPP
+
+#include <gtest/gtest.h>
+
+#include <cpp-anvil/anvil.hpp>
+#include <cpp-anvil/nbt.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+//! @brief Returns the storage of the directory used by the running test.
+inline std::filesystem::path& currentTestDirectory()
+{
+    static std::filesystem::path directory;
+    return directory;
+}
+
+//! @brief Returns a temporary directory for the files of the running test.
+//! @details
+//! The directory is created on the first call within a test. Its name contains the test name and
+//! a random suffix, so that tests running in parallel or repeatedly never share their files. It
+//! is removed at the end of the test by @ref TestDirectoryCleanup.
+//!
+//! @return Path of the directory.
+inline std::filesystem::path testDirectory()
+{
+    std::filesystem::path& directory = currentTestDirectory();
+    if(directory.empty()) {
+        const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::random_device random;
+
+        std::string name = "cpp-anvil-test";
+        if(info) {
+            name += std::string("-") + info->test_suite_name() + "." + info->name();
+        }
+        name += "-" + std::to_string(random()) + std::to_string(random());
+        directory = std::filesystem::temp_directory_path() / name;
+        std::filesystem::create_directories(directory);
+    }
+    return directory;
+}
+
+//! @brief Removes the directory of @ref testDirectory() after every test.
+class TestDirectoryCleanup : public ::testing::EmptyTestEventListener
+{
+public:
+    void OnTestEnd(const ::testing::TestInfo&) override
+    {
+        std::filesystem::path& directory = currentTestDirectory();
+        if(!directory.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(directory, ec);
+            directory.clear();
+        }
+    }
+};
+
+//! @brief Creates the root tag of a test chunk.
+//! @param chunkCoord World coordinates of the chunk, stored in `xPos` and `zPos`.
+//! @param dataSize Number of longs in the `data` array, which are all set to the x coordinate.
+//! @return The root tag.
+inline std::unique_ptr<anvil::CompoundTag> makeChunkTag(anvil::Vec2 chunkCoord,
+                                                        size_t dataSize = 256)
+{
+    auto root = std::make_unique<anvil::CompoundTag>("");
+    root->push_back(std::make_unique<anvil::IntTag>("xPos", chunkCoord.x));
+    root->push_back(std::make_unique<anvil::IntTag>("yPos", -4));
+    root->push_back(std::make_unique<anvil::IntTag>("zPos", chunkCoord.z));
+    root->push_back(std::make_unique<anvil::StringTag>("Status", "minecraft:full"));
+    root->push_back(std::make_unique<anvil::LongArrayTag>(
+        "data", std::vector<anvil::LongType>(dataSize, chunkCoord.x)));
+    return root;
+}
+
+//! @brief Returns the indices of every n-th chunk of a region, starting with the first.
+inline std::vector<size_t> everyNthChunk(size_t step)
+{
+    std::vector<size_t> indices;
+    for(size_t index = 0; index < anvil::Region::Chunks; index += step) {
+        indices.push_back(index);
+    }
+    return indices;
+}
+
+//! @brief Writes a region file with test chunks.
+//! @param directory Directory of the region file, it is created if needed.
+//! @param regionCoord Coordinates of the region, they determine the filename and the chunk
+//!                   coordinates.
+//! @param indices Indices of the chunks to be written, see @ref makeChunkTag().
+//! @param dataSize Number of longs in the `data` array of every chunk.
+//! @return Filename of the region file.
+inline std::string writeTestRegion(const std::filesystem::path& directory,
+                                   anvil::Vec2 regionCoord,
+                                   const std::vector<size_t>& indices,
+                                   size_t dataSize = 256)
+{
+    std::filesystem::create_directories(directory);
+    const std::string filename = (directory
+                                  / ("r." + std::to_string(regionCoord.x) + "."
+                                     + std::to_string(regionCoord.z) + ".mca"))
+                                     .string();
+
+    anvil::Region region;
+    for(size_t index : indices) {
+        const anvil::Vec2 chunkCoord =
+            anvil::chunkRegion2ChunkWorld(anvil::Region::fromIndex(index), regionCoord);
+        region.chunkAt(index).setRootTag(makeChunkTag(chunkCoord, dataSize));
+    }
+    EXPECT_TRUE(region.saveToFile(filename));
+    return filename;
+}
+
+//! @brief Writes the region file `r.0.0.mca` with test chunks to @ref testDirectory().
+inline std::string writeTestRegion(const std::vector<size_t>& indices)
+{
+    return writeTestRegion(testDirectory(), {0, 0}, indices);
+}
+
+//! @brief Writes a test world with the regions (0, 0), (-1, 0) and (0, -1).
+//! @details
+//! Every 9th chunk of the regions is stored, each with a 32 KiB `data` array.
+//!
+//! @return Directory of the world within @ref testDirectory().
+inline std::string createTestWorld()
+{
+    const std::filesystem::path directory = testDirectory() / "world";
+    for(anvil::Vec2 regionCoord : {anvil::Vec2{0, 0}, anvil::Vec2{-1, 0}, anvil::Vec2{0, -1}}) {
+        writeTestRegion(directory / "region", regionCoord, everyNthChunk(9), 4096);
+    }
+    return directory.string();
+}
+
+} // namespace test
+
+#endif // CPP_ANVIL_TEST_REGION_DATA_HPP
@@ -5,6 +5,9 @@
 
 #include "test_data.hpp"
 
+#include <filesystem>
+#include <fstream>
+
 TEST(compression, deflate_inflate_zlib)
 {
     std::vector<unsigned char> input(&bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
@@ -38,3 +41,207 @@ TEST(compression, deflate_inflate_gzip)
                 ::testing::ElementsAreArray(&bigtestUncompressedData[0],
                                             &bigtestUncompressedData[0] + 1544));
 }
+
+TEST(compression, deflate_inflate_streams)
+{
+    // The stream overloads use whole buffers with libdeflate and streaming with zlib.
+    const std::filesystem::path filename =
+        std::filesystem::temp_directory_path() / "cpp-anvil-compression-stream.bin";
+    const std::vector<unsigned char> input(&bigtestUncompressedData[0],
+                                           &bigtestUncompressedData[1544]);
+
+    for(bool gzip : {true, false}) {
+        {
+            std::ofstream out(filename, std::ios::binary);
+            std::vector<unsigned char> data = input;
+            EXPECT_TRUE(gzip ? anvil::deflate_gzip(out, data, anvil::DefaultCompression)
+                             : anvil::deflate_zlib(out, data, anvil::DefaultCompression));
+        }
+
+        std::ifstream in(filename, std::ios::binary);
+        std::vector<unsigned char> output;
+        EXPECT_TRUE(gzip ? anvil::inflate_gzip(in, output) : anvil::inflate_zlib(in, output));
+        EXPECT_EQ(output, input);
+    }
+}
+
+TEST(compression, deflate_inflate_lz4)
+{
+    if(!anvil::isLz4Supported()) {
+        GTEST_SKIP() << "Built without LZ4 support.";
+    }
+
+    // More than one block of 64 KiB
+    std::vector<unsigned char> input;
+    for(size_t i = 0; i < 100; ++i) {
+        input.insert(input.end(), &bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+    }
+
+    std::vector<unsigned char> intermediate;
+    std::vector<unsigned char> output;
+
+    EXPECT_TRUE(anvil::deflate_lz4(input, intermediate));
+    EXPECT_TRUE(anvil::isLz4Compressed(intermediate));
+    EXPECT_LT(intermediate.size(), input.size());
+    EXPECT_TRUE(anvil::inflate_lz4(intermediate, output));
+    EXPECT_EQ(output, input);
+
+    // The stream must end with exactly one end marker.
+    std::vector<unsigned char> truncated(intermediate.begin(), intermediate.end() - 21);
+    EXPECT_FALSE(anvil::inflate_lz4(truncated, output));
+    std::vector<unsigned char> trailing = intermediate;
+    trailing.push_back(0);
+    EXPECT_FALSE(anvil::inflate_lz4(trailing, output));
+
+    // Blocks are verified by their checksum.
+    intermediate[17] ^= 0x01;
+    EXPECT_FALSE(anvil::inflate_lz4(intermediate, output));
+}
+
+TEST(compression, detect_compression)
+{
+    std::vector<unsigned char> input(&bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+    EXPECT_TRUE(anvil::isUncompressed(input));
+    EXPECT_EQ(anvil::testCompression(input), anvil::CompressionType::Uncompressed);
+
+    std::vector<unsigned char> gzip;
+    ASSERT_TRUE(anvil::deflate_gzip(input, gzip));
+    EXPECT_FALSE(anvil::isUncompressed(gzip));
+    EXPECT_EQ(anvil::testCompression(gzip), anvil::CompressionType::Gzip);
+
+    std::vector<unsigned char> zlib;
+    ASSERT_TRUE(anvil::deflate_zlib(input, zlib));
+    EXPECT_FALSE(anvil::isUncompressed(zlib));
+    EXPECT_EQ(anvil::testCompression(zlib), anvil::CompressionType::Zlib);
+
+    // LZ4 block streams are detected by their magic, also without LZ4 support.
+    const std::vector<unsigned char> lz4{'L', 'Z', '4', 'B', 'l', 'o', 'c', 'k', 0x10};
+    EXPECT_FALSE(anvil::isUncompressed(lz4));
+    EXPECT_EQ(anvil::testCompression(lz4), anvil::CompressionType::Lz4);
+
+    const std::vector<unsigned char> truncated(lz4.begin(), lz4.begin() + 7);
+    EXPECT_TRUE(anvil::isUncompressed(truncated));
+    EXPECT_EQ(anvil::testCompression(truncated), anvil::CompressionType::Uncompressed);
+
+    if(anvil::isLz4Supported()) {
+        std::vector<unsigned char> compressed;
+        ASSERT_TRUE(anvil::deflate_lz4(input, compressed));
+        EXPECT_EQ(anvil::testCompression(compressed), anvil::CompressionType::Lz4);
+    }
+}
+
+TEST(compression, reuse_contexts)
+{
+    std::vector<unsigned char> input(&bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+
+    anvil::Deflater deflater(anvil::BestSpeed);
+    anvil::Inflater inflater;
+    EXPECT_EQ(deflater.compressionLevel(), anvil::BestSpeed);
+
+    // Alternate the formats, every buffer resets the contexts.
+    for(auto compression : {anvil::CompressionType::Zlib, anvil::CompressionType::Gzip,
+                            anvil::CompressionType::Zlib, anvil::CompressionType::Uncompressed}) {
+        std::vector<unsigned char> intermediate;
+        std::vector<unsigned char> output;
+        EXPECT_TRUE(deflater.deflate(compression, input, intermediate));
+        EXPECT_TRUE(inflater.inflate(compression, intermediate, output));
+        EXPECT_EQ(output, input);
+    }
+
+    // Truncated data
+    std::vector<unsigned char> intermediate;
+    std::vector<unsigned char> output;
+    EXPECT_TRUE(anvil::Deflater::threadLocal().deflate(anvil::CompressionType::Zlib, input,
+                                                       intermediate));
+    intermediate.resize(intermediate.size() / 2);
+    EXPECT_FALSE(anvil::Inflater::threadLocal().inflate(anvil::CompressionType::Zlib,
+                                                        intermediate, output));
+    EXPECT_FALSE(inflater.inflate(static_cast<anvil::CompressionType>(127), input, output));
+}
+
+TEST(compression, byte_span_reused_buffer)
+{
+    std::vector<unsigned char> input(&bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+    const auto bytes = std::as_bytes(std::span<const unsigned char>(input));
+
+    std::vector<unsigned char> intermediate;
+    std::vector<unsigned char> output;
+    output.reserve(4096);
+    const unsigned char* buffer = output.data();
+
+    EXPECT_TRUE(anvil::deflate_zlib(bytes, intermediate));
+    EXPECT_TRUE(anvil::inflate_zlib(std::as_bytes(std::span<const unsigned char>(intermediate)),
+                                    output, input.size()));
+    EXPECT_EQ(output, input);
+    EXPECT_EQ(output.data(), buffer);
+
+    // A wrong hint only costs growing the buffer.
+    EXPECT_TRUE(anvil::deflate_gzip(bytes, intermediate, anvil::BestCompression));
+    EXPECT_TRUE(anvil::inflate_gzip(std::as_bytes(std::span<const unsigned char>(intermediate)),
+                                    output, 16));
+    EXPECT_EQ(output, input);
+}
+
+TEST(compression, inflate_size_hints)
+{
+    std::vector<unsigned char> input;
+    for(size_t i = 0; i < 20; ++i) {
+        input.insert(input.end(), &bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+    }
+
+    std::vector<unsigned char> gzip;
+    std::vector<unsigned char> zlib;
+    std::vector<unsigned char> output;
+    EXPECT_TRUE(anvil::deflate_gzip(input, gzip));
+    EXPECT_TRUE(anvil::deflate_zlib(input, zlib));
+
+    anvil::Inflater inflater;
+
+    // The size of gzip data is read from its trailer.
+    EXPECT_TRUE(inflater.inflate(anvil::CompressionType::Gzip, gzip, output));
+    EXPECT_EQ(output, input);
+    EXPECT_EQ(inflater.stats().hintedBuffers, 1u);
+    EXPECT_EQ(inflater.stats().exactHints, 1u);
+    EXPECT_EQ(inflater.stats().reallocations, 0u);
+
+    // Without a hint, zlib data grows the buffer.
+    EXPECT_TRUE(inflater.inflate(anvil::CompressionType::Zlib, zlib, output));
+    EXPECT_EQ(output, input);
+    EXPECT_GT(inflater.stats().reallocations, 0u);
+    EXPECT_EQ(inflater.stats().avoidedReallocations, inflater.stats().reallocations);
+
+    inflater.resetStats();
+    EXPECT_TRUE(inflater.inflate(anvil::CompressionType::Zlib, zlib, output, input.size()));
+    EXPECT_EQ(output, input);
+    EXPECT_EQ(inflater.stats().buffers, 1u);
+    EXPECT_EQ(inflater.stats().reallocations, 0u);
+}
+
+TEST(compression, deflate_parallel)
+{
+    // Several blocks of 128 KiB
+    std::vector<unsigned char> input;
+    for(size_t i = 0; i < 200; ++i) {
+        input.insert(input.end(), &bigtestUncompressedData[0], &bigtestUncompressedData[1544]);
+        input.push_back(static_cast<unsigned char>(i));
+    }
+
+    std::vector<unsigned char> single;
+    std::vector<unsigned char> parallel;
+    std::vector<unsigned char> output;
+
+    EXPECT_TRUE(anvil::deflate_gzip(input, single, anvil::BestCompression));
+    EXPECT_TRUE(anvil::deflate_gzip(input, parallel, anvil::BestCompression, 4));
+    EXPECT_TRUE(anvil::isGzipCompressed(parallel));
+    EXPECT_LT(parallel.size(), single.size() * 11 / 10);
+    EXPECT_TRUE(anvil::inflate_gzip(parallel, output));
+    EXPECT_EQ(output, input);
+
+    EXPECT_TRUE(anvil::deflate_zlib(input, parallel, anvil::BestSpeed, 3));
+    EXPECT_TRUE(anvil::inflate_zlib(parallel, output));
+    EXPECT_EQ(output, input);
+
+    // A single thread produces the same data as the single threaded function.
+    EXPECT_TRUE(anvil::deflate_gzip(input, parallel, anvil::BestCompression, 1));
+    EXPECT_EQ(parallel, single);
+}